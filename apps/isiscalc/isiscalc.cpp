@@ -5,19 +5,22 @@
 
 using namespace isis;
 
-class VoxelOp : public data::VoxelOp<double>
+class VoxelOp : public data::ParallelVoxelOp<double>
 {
+	const std::string expr;
 	mu::Parser parser;
 	double voxBuff;
 	util::FixedVector<double, 4> posBuff;
 public:
-	VoxelOp( std::string expr ) {
+	VoxelOp( std::string _expr ): expr( _expr ) {
 		parser.SetExpr( expr );
 		parser.DefineVar( std::string( "vox" ), &voxBuff );
 		parser.DefineVar( std::string( "pos_x" ), &posBuff[data::rowDim] );
 		parser.DefineVar( std::string( "pos_y" ), &posBuff[data::columnDim] );
 		parser.DefineVar( std::string( "pos_z" ), &posBuff[data::sliceDim] );
 		parser.DefineVar( std::string( "pos_t" ), &posBuff[data::timeDim] );
+		voxBuff = 0;
+		parser.Eval(); // parse the term now, so syntax errors are thrown here and not in some worker thread
 	}
 	bool operator()( double &vox, const isis::util::vector4<size_t>& pos ) {
 		voxBuff = vox; //using parser.DefineVar every time would slow down the evaluation
@@ -25,6 +28,10 @@ public:
 		vox = parser.Eval();
 		return true;
 	}
+	// the parser is bound to the buffers of its op, so every thread needs its own one
+	VoxelOp *clone()const {
+		return new VoxelOp( expr );
+	}
 
 };
 
@@ -43,7 +50,8 @@ int main( int argc, char **argv )
 
 		BOOST_FOREACH( data::Image & img, app.images ) {
 			std::cout << "Computing vox=(" << op << ") for each voxel of the " << img.getSizeAsString() << "-Image" << std::endl;
-			img.foreachVoxel<double>( vop );
+
+			img.foreachVoxel<double>( vop ); // runs in parallel if enabled by -threads
 		}
 	} catch( mu::Parser::exception_type &e ) {
 		std::cerr << e.GetMsg() << std::endl;
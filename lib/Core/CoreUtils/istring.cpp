@@ -33,7 +33,12 @@ namespace util
 namespace _internal
 {
 
-std::locale const ichar_traits::loc = std::locale( "C" );
+// case folding as done by std::tolower in the "C" locale
+// this is much cheaper than std::tolower with a locale, which has to look up the ctype facet for every character
+static inline char foldCase( const char c )
+{
+	return ( c >= 'A' && c <= 'Z' ) ? c + ( 'a' - 'A' ) : c;
+}
 
 int ichar_traits::compare( const char *s1, const char *s2, size_t n )
 {
@@ -46,29 +51,29 @@ int ichar_traits::compare( const char *s1, const char *s2, size_t n )
 
 bool ichar_traits::eq( const char &c1, const char &c2 )
 {
-	return std::tolower( c1, loc ) == std::tolower( c2, loc );
+	return foldCase( c1 ) == foldCase( c2 );
 }
 
 bool ichar_traits::lt( const char &c1, const char &c2 )
 {
-	return std::tolower( c1, loc ) < std::tolower( c2, loc );
+	return foldCase( c1 ) < foldCase( c2 );
 }
 
 const char *ichar_traits::find( const char *s, size_t n, const char &a )
 {
-	const char lowA = std::tolower( a );
+	const char lowA = foldCase( a );
 
-	if( lowA == std::toupper( a ) ) { // if a has no cases we can do naive search
-		return std::find( s, s + n, a );
+	if( lowA == a && ( a < 'a' || a > 'z' ) ) { // if a has no cases we can do naive search
+		const char *const end = s + n, *const found = std::find( s, end, a );
+		return found != end ? found : NULL;
 	} else for( size_t i = 0; i < n; i++, s++ ) {
-			if( std::tolower( *s ) == lowA )
+			if( foldCase( *s ) == lowA )
 				return s;
 		}
 
 	return NULL;
 }
 
-
 }
 }
 }
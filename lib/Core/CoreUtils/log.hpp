@@ -18,6 +18,7 @@
 #include "message.hpp"
 #include "singletons.hpp"
 #include <limits.h>
+#include <boost/atomic.hpp>
 
 /// @cond _internal
 namespace isis
@@ -31,23 +32,49 @@ template<class MODULE> class Log
 {
 	friend class util::Singletons;
 	boost::shared_ptr<MessageHandlerBase> m_handle;
+	// cached level of the current handler plus one (0 means unknown, 1 means there is no handler)
+	// so the macros can drop messages without building them
+	static boost::atomic<int> s_pass_below;
 	static boost::shared_ptr<MessageHandlerBase> &getHandle() {
 		boost::shared_ptr<util::MessageHandlerBase> &handle = Singletons::get < Log<MODULE>, INT_MAX - 1 > ().m_handle;
 		return handle;
 	}
-	Log(): m_handle( new DefaultMsgPrint( notice ) ) {}
+	static void cacheLevel( const boost::shared_ptr<MessageHandlerBase> &handler ) {
+		s_pass_below.store( handler ? handler->m_level + 1 : 1, boost::memory_order_relaxed );
+	}
+	Log(): m_handle( new DefaultMsgPrint( notice ) ) {cacheLevel( m_handle );}
 public:
 	template<class HANDLE_CLASS> static void enable( LogLevel enable ) {
 		setHandler( boost::shared_ptr<MessageHandlerBase>( enable ? new HANDLE_CLASS( enable ) : 0 ) );
 	}
+	// the handler may be replaced by another thread while messages are sent, so its only accessed atomically
 	static void setHandler( boost::shared_ptr<MessageHandlerBase> handler ) {
-		getHandle() = handler;
+		boost::atomic_store( &getHandle(), handler );
+		cacheLevel( handler );
+	}
+	/**
+	 * Check if a message of the given level would be committed by the current handler.
+	 * This is just a relaxed load and compare, so its cheap enough to be done before every message.
+	 * \note the level of the handler is read when the handler is set, later changes of its m_level are not seen here
+	 */
+	static bool passes( LogLevel level ) {
+		int pass_below = s_pass_below.load( boost::memory_order_relaxed );
+
+		if( pass_below == 0 ) { // nothing cached yet (e.g. the log singleton was not created yet), so ask the handler
+			const boost::shared_ptr<MessageHandlerBase> handle = boost::atomic_load( &getHandle() );
+			int expected = 0; // don't overwrite the level cached by a concurrent setHandler
+			s_pass_below.compare_exchange_strong( expected, handle ? handle->m_level + 1 : 1, boost::memory_order_relaxed );
+			pass_below = s_pass_below.load( boost::memory_order_relaxed );
+		}
+
+		return level < pass_below;
 	}
 	static Message send( const char file[], const char object[], int line, LogLevel level ) {
-		boost::shared_ptr<util::MessageHandlerBase> &handle = getHandle();
+		const boost::shared_ptr<util::MessageHandlerBase> handle = boost::atomic_load( &getHandle() );
 		return Message( object, MODULE::name(), file, line, level, handle );
 	}
 };
+template<class MODULE> boost::atomic<int> Log<MODULE>::s_pass_below( 0 );
 
 }
 }
@@ -57,10 +84,11 @@ public:
 #define ENABLE_LOG(MODULE,HANDLE_CLASS,set)\
 	if(!MODULE::use);else isis::util::_internal::Log<MODULE>::enable<HANDLE_CLASS>(set)
 
+// the level is checked before the message is created, so the stream operands of dropped messages are not evaluated
 #define LOG(MODULE,LEVEL)\
-	if(!MODULE::use);else isis::util::_internal::Log<MODULE>::send(__FILE__,__FUNCTION__,__LINE__,LEVEL)
+	if(!(MODULE::use && isis::util::_internal::Log<MODULE>::passes(LEVEL)));else isis::util::_internal::Log<MODULE>::send(__FILE__,__FUNCTION__,__LINE__,LEVEL)
 
 #define LOG_IF(PRED,MODULE,LEVEL)\
-	if(!(MODULE::use && (PRED)));else isis::util::_internal::Log<MODULE>::send(__FILE__,__FUNCTION__,__LINE__,LEVEL)
+	if(!(MODULE::use && (PRED) && isis::util::_internal::Log<MODULE>::passes(LEVEL)));else isis::util::_internal::Log<MODULE>::send(__FILE__,__FUNCTION__,__LINE__,LEVEL)
 
 #endif
@@ -15,6 +15,13 @@
 #include <sys/types.h>
 
 #include <boost/date_time/posix_time/posix_time.hpp> //we need the to_string functions for the automatic conversion
+#include <boost/thread/locks.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/bind.hpp>
 
 #ifndef WIN32
 #include <signal.h>
@@ -30,6 +37,114 @@ struct IsEqualMsg {
 	std::string newMsg;
 	bool operator()( const std::pair<boost::posix_time::ptime, std::string>& ms ) {return ms.second == newMsg;}
 };
+
+// bounded multi-producer ring buffer of messages with one consumer thread printing them (used by AsyncMsgPrint)
+// the buffer is the one of D. Vyukov: every cell has a sequence number telling if its free for the producer at pos (seq==pos) or filled for the consumer (seq==pos+1)
+class AsyncLogQueue: boost::noncopyable
+{
+	friend class util::Singletons;
+	struct Cell {
+		boost::atomic<size_t> sequence;
+		Message *msg;
+	};
+	static const size_t capacity = 1024; // must be a power of two
+	boost::scoped_array<Cell> m_cells;
+	boost::atomic<size_t> m_enqueue, m_written;
+	size_t m_dequeue; // only used by the consumer
+	boost::atomic<bool> m_stop;
+	boost::atomic<bool> m_sleeping; // set while the consumer waits, so producers only notify if needed
+	boost::mutex m_mutex;
+	boost::condition_variable m_wakeup;
+	boost::thread m_consumer;
+
+	AsyncLogQueue(): m_cells( new Cell[capacity] ), m_enqueue( 0 ), m_written( 0 ), m_dequeue( 0 ), m_stop( false ), m_sleeping( false ) {
+		for( size_t i = 0; i < capacity; i++ )
+			m_cells[i].sequence.store( i, boost::memory_order_relaxed );
+
+		m_consumer = boost::thread( boost::bind( &AsyncLogQueue::consume, this ) );
+	}
+	bool empty()const {
+		return m_cells[m_dequeue & ( capacity - 1 )].sequence.load( boost::memory_order_acquire ) != m_dequeue + 1;
+	}
+	Message *pop() {
+		Cell &cell = m_cells[m_dequeue & ( capacity - 1 )];
+
+		if( cell.sequence.load( boost::memory_order_acquire ) != m_dequeue + 1 )
+			return NULL; // empty
+
+		Message *const ret = cell.msg;
+		cell.sequence.store( m_dequeue + capacity, boost::memory_order_release ); // free it for the producer one round later
+		m_dequeue++;
+		return ret;
+	}
+	void consume() {
+		DefaultMsgPrint printer( verbose_info );
+
+		while( true ) {
+			for( Message *msg = pop(); msg; msg = pop() ) {
+				const boost::scoped_ptr<Message> guard( msg );
+				printer.commit( *msg );
+				m_written++;
+			}
+
+			if( m_stop ) {
+				if( m_enqueue.load() == m_written.load() ) // nothing left in flight
+					return;
+				else
+					continue;
+			}
+
+			// producers don't lock the mutex, so a wakeup can get lost - so don't sleep for too long
+			boost::unique_lock<boost::mutex> lock( m_mutex );
+			m_sleeping = true;
+
+			if( empty() ) // a message pushed before m_sleeping was set would not wake us up
+				m_wakeup.timed_wait( lock, boost::posix_time::milliseconds( 10 ) );
+
+			m_sleeping = false;
+		}
+	}
+public:
+	~AsyncLogQueue() { // write everything left and stop the consumer
+		m_stop = true;
+		m_wakeup.notify_one();
+		m_consumer.join();
+	}
+	// \returns false if the buffer is full (msg is not taken then)
+	bool push( Message *msg ) {
+		size_t pos = m_enqueue.load( boost::memory_order_relaxed );
+
+		while( true ) {
+			Cell &cell = m_cells[pos & ( capacity - 1 )];
+			const size_t seq = cell.sequence.load( boost::memory_order_acquire );
+
+			if( seq == pos ) { // its free, try to get it
+				if( m_enqueue.compare_exchange_weak( pos, pos + 1, boost::memory_order_relaxed ) ) {
+					cell.msg = msg;
+					cell.sequence.store( pos + 1, boost::memory_order_release );
+
+					if( m_sleeping.load( boost::memory_order_relaxed ) ) // notify_one locks a mutex, so avoid it if possible
+						m_wakeup.notify_one();
+
+					return true;
+				}
+			} else if( seq < pos ) { // its still filled from the last round - we are full
+				return false;
+			} else // another producer got it first
+				pos = m_enqueue.load( boost::memory_order_relaxed );
+		}
+	}
+	void flush() {
+		const size_t target = m_enqueue.load();
+
+		while( m_written.load() < target ) {
+			m_wakeup.notify_one();
+			boost::this_thread::sleep( boost::posix_time::milliseconds( 1 ) );
+		}
+	}
+};
+boost::atomic<int> async_overflow_policy( AsyncMsgPrint::block_sender );
+boost::atomic<size_t> async_dropped( 0 );
 }
 const char *logLevelName( LogLevel level )
 {
@@ -103,11 +218,14 @@ Message::Message( const Message &src ) //we need a custom copy-constructor, beca
 
 Message::~Message()
 {
-	if ( shouldCommit() ) {
-		commitTo.lock()->commit( *this );
+	// keep the handler alive, it might be replaced by another thread meanwhile
+	const boost::shared_ptr<MessageHandlerBase> handler( commitTo.lock() );
+
+	if ( handler && shouldCommit() ) {
+		handler->commit( *this );
 		str( "" );
 		clear();
-		commitTo.lock()->requestStop( m_level );
+		handler->requestStop( m_level );
 	}
 }
 
@@ -145,8 +263,10 @@ LogLevel MessageHandlerBase::m_stop_below = error;
 
 
 std::ostream *DefaultMsgPrint::o = &::std::cerr;
+boost::mutex DefaultMsgPrint::m_mutex;
 void DefaultMsgPrint::commit( const Message &mesg )
 {
+	const boost::lock_guard<boost::mutex> lock( m_mutex );
 	//first remove everything which is to old anyway
 	std::list< std::pair<boost::posix_time::ptime, std::string> >::iterator begin = last.begin();
 	static const boost::posix_time::millisec dist( max_age );
@@ -178,9 +298,46 @@ void DefaultMsgPrint::commit( const Message &mesg )
 
 void DefaultMsgPrint::setStream( ::std::ostream &_o )
 {
+	const boost::lock_guard<boost::mutex> lock( m_mutex );
 	o->flush();
 	o = &_o;
 }
 
+void AsyncMsgPrint::commit( const Message &mesg )
+{
+	// make a copy which is not connected to any handler, so it won't commit itself again when its deleted
+	Message *const copy = new Message( mesg.m_object, mesg.m_module, mesg.m_file.string(), mesg.m_line, mesg.m_level, boost::weak_ptr<MessageHandlerBase>() );
+	copy->str( mesg.str() );
+	copy->m_subjects = mesg.m_subjects;
+	copy->m_timeStamp = mesg.m_timeStamp;
+
+	_internal::AsyncLogQueue &queue = Singletons::get<_internal::AsyncLogQueue, INT_MAX>();
+
+	while( !queue.push( copy ) ) {
+		if( _internal::async_overflow_policy.load( boost::memory_order_relaxed ) == drop_message ) {
+			_internal::async_dropped++;
+			delete copy;
+			return;
+		}
+
+		boost::this_thread::yield();
+	}
+}
+
+void AsyncMsgPrint::setOverflowPolicy( OverflowPolicy policy )
+{
+	_internal::async_overflow_policy = policy;
+}
+
+void AsyncMsgPrint::flush()
+{
+	Singletons::get<_internal::AsyncLogQueue, INT_MAX>().flush();
+}
+
+size_t AsyncMsgPrint::droppedMessages()
+{
+	return _internal::async_dropped;
+}
+
 }
 }
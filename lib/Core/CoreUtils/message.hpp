@@ -22,6 +22,7 @@
 #include <boost/filesystem/path.hpp>
 #include <boost/weak_ptr.hpp>
 #include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace isis
 {
@@ -89,6 +90,7 @@ public:
  * Will print any issued message to the given output stream in the format:  "LOG_MODULE_NAME:LOG_LEVEL_NAME[LOCATION] MESSAGE"
  * The default output stream is std::cout. But can be set using setStream.
  * Location is the calling Object/Method if compiled without debug infos (NDEBUG is set) or FILENAME:LINE_NUMER if compiled with debug infos.
+ * Messages from different threads are serialized, so they won't be interleaved.
  */
 class DefaultMsgPrint : public MessageHandlerBase
 {
@@ -96,6 +98,7 @@ protected:
 	static std::ostream *o;
 	static const int max_age = 500;
 	std::list<std::pair<boost::posix_time::ptime, std::string> > last;
+	static boost::mutex m_mutex; // protects last and the output stream
 
 public:
 	DefaultMsgPrint( LogLevel level ): MessageHandlerBase( level ) {}
@@ -104,6 +107,32 @@ public:
 	static void setStream( std::ostream &_o );
 };
 
+/**
+ * Asynchronous message output class.
+ * Prints messages in the same format as DefaultMsgPrint (to the stream set by DefaultMsgPrint::setStream).
+ * But commit only copies the message into a bounded lock-free ring buffer, the output is done by a single background thread.
+ * So threads which are logging don't wait for the output or for each other.
+ * The buffer and the thread are shared by all AsyncMsgPrint handlers. Messages still in the buffer are written when the program ends.
+ * \code
+ * ENABLE_LOG( data::Runtime, util::AsyncMsgPrint, info );
+ * \endcode
+ */
+class AsyncMsgPrint : public MessageHandlerBase
+{
+public:
+	/// what to do with a new message if the buffer is full
+	enum OverflowPolicy {drop_message, block_sender};
+	AsyncMsgPrint( LogLevel level ): MessageHandlerBase( level ) {}
+	virtual ~AsyncMsgPrint() {}
+	void commit( const Message &mesg );
+	/// Set what to do if the buffer is full (default is block_sender).
+	static void setOverflowPolicy( OverflowPolicy policy );
+	/// Block until all messages committed so far are written.
+	static void flush();
+	/// \returns the amount of messages dropped so far because the buffer was full
+	static size_t droppedMessages();
+};
+
 }
 }
 #endif //MESSAGE_H
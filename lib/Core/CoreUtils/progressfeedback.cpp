@@ -19,6 +19,9 @@
 
 #include "progressfeedback.hpp"
 #include "common.hpp"
+#include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/locks.hpp>
 
 namespace isis
 {
@@ -72,5 +75,91 @@ size_t ConsoleFeedback::progress( const std::string message, size_t step )
 }
 
 
+ParallelFeedback::ParallelFeedback( boost::shared_ptr<ProgressFeedback> target, unsigned short interval_ms )
+	: m_forwarded( 0 ), m_target( target ), m_interval( interval_ms ), m_stop( false )
+{
+	assert( m_target );
+
+	for( size_t i = 0; i < counters; i++ )
+		m_counters[i].value.store( 0, boost::memory_order_relaxed );
+
+	m_renderer = boost::thread( boost::bind( &ParallelFeedback::render, this ) );
+}
+
+ParallelFeedback::~ParallelFeedback()
+{
+	{
+		const boost::lock_guard<boost::mutex> lock( m_mutex );
+		m_stop = true;
+	}
+	m_stop_cond.notify_all();
+	m_renderer.join();
+
+	const boost::lock_guard<boost::mutex> lock( m_mutex );
+	forward();
+}
+
+size_t ParallelFeedback::sum()const
+{
+	size_t ret = 0;
+
+	for( size_t i = 0; i < counters; i++ )
+		ret += m_counters[i].value.load( boost::memory_order_relaxed );
+
+	return ret;
+}
+
+void ParallelFeedback::forward()
+{
+	const size_t now = sum();
+
+	if( now > m_forwarded ) {
+		m_target->progress( "", now - m_forwarded );
+		m_forwarded = now;
+	}
+}
+
+void ParallelFeedback::render()
+{
+	boost::unique_lock<boost::mutex> lock( m_mutex );
+
+	while( !m_stop ) {
+		m_stop_cond.timed_wait( lock, m_interval );
+		forward();
+	}
+}
+
+void ParallelFeedback::show( size_t max, std::string header )
+{
+	const boost::lock_guard<boost::mutex> lock( m_mutex );
+	m_target->show( max, header );
+}
+
+size_t ParallelFeedback::progress( const std::string /*message*/, size_t step )
+{
+	// threads are spread over the counters by their id, threads sharing a counter still count correctly
+	m_counters[boost::hash<boost::thread::id>()( boost::this_thread::get_id() ) % counters].value.fetch_add( step, boost::memory_order_relaxed );
+	return m_forwarded.load( boost::memory_order_relaxed ); // summing up all counters here would touch all their cache lines
+}
+
+void ParallelFeedback::close()
+{
+	const boost::lock_guard<boost::mutex> lock( m_mutex );
+	forward();
+	m_target->close();
+}
+
+size_t ParallelFeedback::getMax()
+{
+	const boost::lock_guard<boost::mutex> lock( m_mutex );
+	return m_target->getMax();
+}
+
+size_t ParallelFeedback::extend( size_t by )
+{
+	const boost::lock_guard<boost::mutex> lock( m_mutex );
+	return m_target->extend( by );
+}
+
 }
 }
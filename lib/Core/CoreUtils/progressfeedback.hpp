@@ -22,6 +22,11 @@
 #include <string>
 #include <boost/progress.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 namespace isis
 {
@@ -70,6 +75,52 @@ public:
 	void show( size_t max, std::string header );
 	size_t extend( size_t by );
 };
+
+/**
+ * Progress feedback which can be advanced by many threads at the same time.
+ * It forwards to another feedback (e.g. a ConsoleFeedback), which only has to be usable by one thread.
+ * progress() just adds to an atomic counter (there are multiple counters, threads are spread over them to avoid contention).
+ * A background thread collects the counters in a fixed interval and passes their sum on to the wrapped feedback.
+ * So the display is redrawn at most once per interval, no matter how many steps are made.
+ * show, extend and close are forwarded immediately. Messages given to progress are not forwarded.
+ */
+class ParallelFeedback: public ProgressFeedback
+{
+	struct Counter {
+		boost::atomic<size_t> value;
+		char padding[64 - sizeof( boost::atomic<size_t> )]; // keep the counters in different cache lines
+	};
+	static const size_t counters = 16;
+	Counter m_counters[counters];
+	boost::atomic<size_t> m_forwarded; // the amount already passed on to m_target
+	const boost::shared_ptr<ProgressFeedback> m_target;
+	const boost::posix_time::milliseconds m_interval;
+	bool m_stop;
+	boost::mutex m_mutex; // protects m_target, m_stop and the writes to m_forwarded
+	boost::condition_variable m_stop_cond;
+	boost::thread m_renderer;
+	size_t sum()const;
+	void forward(); // must be called with m_mutex locked
+	void render();
+public:
+	/**
+	 * Create a feedback forwarding to target and start its background thread.
+	 * \param target the feedback which shall display the progress
+	 * \param interval_ms the time in milliseconds between two updates of target
+	 */
+	ParallelFeedback( boost::shared_ptr<ProgressFeedback> target, unsigned short interval_ms = 100 );
+	/// Stops the background thread and passes the remaining progress to the wrapped feedback.
+	~ParallelFeedback();
+	void show( size_t max, std::string header = "" );
+	/**
+	 * Advance the progress by step. This is safe and cheap to be called from many threads at the same time.
+	 * \returns the amount of progress passed on to the wrapped feedback so far (lags behind by up to one interval)
+	 */
+	size_t progress( const std::string message = "", size_t step = 1 );
+	void close();
+	size_t getMax();
+	size_t extend( size_t by );
+};
 }
 }
 #endif // PROGRESSFEEDBACK_HPP
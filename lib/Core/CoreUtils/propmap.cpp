@@ -64,6 +64,22 @@ bool PropertyMap::operator==( const PropertyMap &src )const
 
 PropertyMap::PropertyMap() {}
 
+PropertyMap::PropPath::PropPath( const char *key )
+{
+	PropPath buff( ( KeyType( key ) ) );
+	swap( buff );
+}
+PropertyMap::PropPath::PropPath( const KeyType &key )
+{
+	if( key.find( pathSeperator ) == KeyType::npos ) { // most paths are just one key - no need to split them
+		if( !key.empty() )
+			push_back( key );
+	} else {
+		std::list<KeyType> buff = util::stringToList<KeyType>( key, pathSeperator );
+		swap( buff );
+	}
+}
+
 
 ///////////////////////////////////////////////////////////////////
 // The core tree traversal functions
@@ -241,7 +257,9 @@ bool PropertyMap::remove( const PropertyMap &removeMap, bool keep_needed )
 		//find the closest match for otherIt->first in this (use the value-comparison-functor of PropMap)
 		if ( continousFind( thisIt, end(), *otherIt, value_comp() ) ) { //thisIt->first == otherIt->first - so its the same property or propmap
 			if ( ! thisIt->second.is_leaf() ) { //this is a branch
-				if ( ! otherIt->second.is_leaf() ) { // recurse if its a branch in the removal map as well
+				if ( thisIt->second.sharesBranch( otherIt->second ) ) { // its the same branch, so everything in it would be removed
+					erase( thisIt++ );
+				} else if ( ! otherIt->second.is_leaf() ) { // recurse if its a branch in the removal map as well
 					PropertyMap &mySub = thisIt->second.getBranch();
 					const PropertyMap &otherSub = otherIt->second.getBranch();
 					ret &= mySub.remove( otherSub );
@@ -296,7 +314,9 @@ void PropertyMap::diffTree( const PropertyMap &other, PropertyMap::DiffMap &ret,
 		if ( _internal::continousFind( otherIt, other.end(), *thisIt, value_comp() ) ) { //otherIt->first == thisIt->first - so its the same property
 			const mapped_type &first = thisIt->second, &second = otherIt->second;
 
-			if ( ! ( first.is_leaf() || second.is_leaf() ) ) { // if both are a branch
+			if ( first.sharesBranch( second ) ) { // if both are the same branch there is no difference
+				continue;
+			} else if ( ! ( first.is_leaf() || second.is_leaf() ) ) { // if both are a branch
 				const PropertyMap &thisMap = first.getBranch();
 				const PropertyMap &refMap = second.getBranch();
 				thisMap.diffTree( refMap, ret, pathname + "/" );
@@ -396,6 +416,8 @@ void PropertyMap::joinTree( const PropertyMap &other, bool overwrite, istring pr
 			if ( thisIt->second.empty() ) { // if ours is empty
 				LOG( Debug, verbose_info ) << "Replacing empty property " << MSubject( thisIt->first ) << " by " << MSubject( otherIt->second );
 				thisIt->second.insert( otherIt->second );
+			} else if ( thisIt->second.sharesBranch( otherIt->second ) ) { // if both are the same subtree there is nothing to join
+				continue;
 			} else if ( ! ( thisIt->second.is_leaf() || otherIt->second.is_leaf() ) ) { // if both are a subtree
 				PropertyMap &thisMap = thisIt->second.getBranch();
 				const PropertyMap &refMap = otherIt->second.getBranch();
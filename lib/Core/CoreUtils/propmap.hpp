@@ -22,6 +22,7 @@
 #include "istring.hpp"
 #include <set>
 #include <algorithm>
+#include <boost/shared_ptr.hpp>
 
 namespace isis
 {
@@ -48,6 +49,12 @@ class treeNode; //predeclare treeNode -- we'll need it in PropertyMap
  *
  * To describe the minimum of needed metadata needed by specific data structures / subclasses
  * properties can be marked as "needed" and there are functions to verify that they are not empty.
+ *
+ * Branches are copy-on-write. Copies of a PropertyMap share their branches until one of them is changed.
+ * So copying big trees (like the DICOM-tags of a chunk) is cheap, and comparing, joining or removing shared branches
+ * is done without looking into them.
+ * But keep in mind that writable references to properties or branches inside a branch (e.g. from branch() or propertyValue())
+ * are only valid until the map is copied. Writing through them after that would change the copy as well.
  */
 class PropertyMap : protected std::map<util::istring, _internal::treeNode>
 {
@@ -61,11 +68,15 @@ public:
 	///a flat map, matching complete paths as keys to the corresponding values
 	typedef std::map<KeyType, PropertyValue> FlatMap;
 
-	/// "Path" type used to locate entries in the tree
+	/**
+	 * "Path" type used to locate entries in the tree.
+	 * Creating a path from a string means parsing it. So for properties which are accessed often (e.g. for every chunk)
+	 * it is faster to create the path once (e.g. as a static const) and use that instead of the string.
+	 */
 	struct PropPath: public std::list<KeyType> {
 		PropPath() {}
-		PropPath( const char *key ): std::list<KeyType>( util::stringToList<KeyType>( util::istring( key ), pathSeperator ) ) {}
-		PropPath( const KeyType &key ): std::list<KeyType>( util::stringToList<KeyType>( key, pathSeperator ) ) {}
+		PropPath( const char *key );
+		PropPath( const KeyType &key );
 		PropPath( const std::list<KeyType> &path ): std::list<KeyType>( path ) {}
 	};
 private:
@@ -440,25 +451,45 @@ namespace _internal
 /**
  * Basic container class for the "values" inside the property tree.
  * This can hold a list of PropertyValues or another PropertyMap.
+ * Branches are shared between copies of a node and only copied when one of the copies is about to be changed (copy-on-write).
+ * So copying a tree only copies its top level, and branches which are shared can be compared by their address.
  */
 class treeNode
 {
-	PropertyMap m_branch;
+	boost::shared_ptr<PropertyMap> m_branch; // may be NULL for an empty branch
 	std::vector<PropertyValue> m_leaf;
+	static const PropertyMap &emptyBranch() {
+		static const PropertyMap empty;
+		return empty;
+	}
 public:
 	treeNode(): m_leaf( 1 ) {}
 	bool empty()const {
-		return m_branch.isEmpty() && m_leaf[0].isEmpty();
+		return getBranch().isEmpty() && m_leaf[0].isEmpty();
 	}
 	bool is_leaf()const {
-		LOG_IF( ! ( m_branch.isEmpty() || m_leaf[0].isEmpty() ), Debug, error ) << "There is a non empty leaf at a branch. This should not be.";
-		return m_branch.isEmpty();
+		LOG_IF( ! ( getBranch().isEmpty() || m_leaf[0].isEmpty() ), Debug, error ) << "There is a non empty leaf at a branch. This should not be.";
+		return getBranch().isEmpty();
 	}
 	const PropertyMap &getBranch()const {
-		return m_branch;
+		return m_branch ? *m_branch : emptyBranch();
 	}
+	/**
+	 * Get a writable reference of the branch.
+	 * If the branch is shared with other nodes, it is copied first.
+	 * \note as with other copy-on-write containers the reference must not be used anymore after the node was copied.
+	 */
 	PropertyMap &getBranch() {
-		return m_branch;
+		if( !m_branch )
+			m_branch.reset( new PropertyMap );
+		else if( !m_branch.unique() )
+			m_branch.reset( new PropertyMap( *m_branch ) );
+
+		return *m_branch;
+	}
+	/// \returns true if this and ref share the same (non-empty) branch - in that case their branches are equal
+	bool sharesBranch( const treeNode &ref )const {
+		return m_branch && m_branch == ref.m_branch && !m_branch->isEmpty();
 	}
 	std::vector<PropertyValue> &getLeaf() {
 		assert( is_leaf() );
@@ -469,7 +500,7 @@ public:
 		return m_leaf;
 	}
 	bool operator==( const treeNode &ref )const {
-		return m_branch == ref.m_branch && m_leaf == ref.m_leaf;
+		return ( m_branch == ref.m_branch || getBranch() == ref.getBranch() ) && m_leaf == ref.m_leaf;
 	}
 	void insert( const treeNode &ref ) {
 		m_branch = ref.m_branch;
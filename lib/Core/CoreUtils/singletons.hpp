@@ -6,6 +6,9 @@
 #include <string>
 #include <iostream>
 #include <typeinfo>
+#include <boost/atomic.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/locks.hpp>
 
 namespace isis
 {
@@ -27,18 +30,18 @@ namespace util
  * Singletons::get < MyClass, INT_MAX - 1 >
  * \endcode
  * This generates a Singleton of MyClass with highest priority.
- * \note This is (currently) not thread save.
+ * \note Creation of the singletons is thread save, the singletons themselves are not made thread save by this.
  */
 class Singletons
 {
 	template <typename C> class Singleton
 	{
 		static void destruct() {
-			if( _instance )delete _instance;
+			C *const buff = _instance.exchange( 0 );
 
-			_instance = 0;
+			if( buff )delete buff;
 		}
-		static C *_instance;
+		static boost::atomic<C *> _instance;
 		Singleton () { }
 	public:
 		friend class Singletons;
@@ -48,6 +51,8 @@ class Singletons
 	typedef std::multimap<int, destructer> prioMap;
 
 	prioMap map;
+	// recursive, because the constructor of a singleton might request other singletons
+	boost::recursive_mutex m_lock;
 	Singletons();
 	virtual ~Singletons();
 	static Singletons &getMaster();
@@ -58,16 +63,24 @@ public:
 	 * \return a reference to the same object of type T.
 	 */
 	template<typename T, int PRIO> static T &get() {
-		if ( !Singleton<T>::_instance ) {
-			Singleton<T>::_instance = new T();
-			prioMap &map = getMaster().map;
-			map.insert( map.find( PRIO ), std::make_pair( PRIO, Singleton<T>::destruct ) );
+		T *ret = Singleton<T>::_instance.load( boost::memory_order_acquire );
+
+		if ( !ret ) {
+			Singletons &master = getMaster();
+			const boost::lock_guard<boost::recursive_mutex> lock( master.m_lock );
+			ret = Singleton<T>::_instance.load( boost::memory_order_relaxed );
+
+			if( !ret ) { // nobody else created it while we where waiting for the lock
+				ret = new T();
+				master.map.insert( master.map.find( PRIO ), std::make_pair( PRIO, Singleton<T>::destruct ) );
+				Singleton<T>::_instance.store( ret, boost::memory_order_release );
+			}
 		}
 
-		return *Singleton<T>::_instance;
+		return *ret;
 	}
 };
-template <typename C> C *Singletons::Singleton<C>::_instance = 0;
+template <typename C> boost::atomic<C *> Singletons::Singleton<C>::_instance( 0 );
 
 }
 }
@@ -0,0 +1,194 @@
+/*
+    Copyright (C) 2010  reimer@cbs.mpg.de
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "threadpool.hpp"
+#include "common.hpp"
+#include "singletons.hpp"
+#include <algorithm>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/exception_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/locks.hpp>
+
+namespace isis
+{
+namespace util
+{
+
+/// @cond _internal
+namespace _internal
+{
+// shared state of the jobs of one ThreadPool::parallelFor call
+// its owned by all tasks taking part, so tasks which start after all jobs are done can still access it
+class JobBatch: boost::noncopyable
+{
+	const boost::function<void( size_t )> m_job;
+	const size_t m_count;
+	boost::atomic<size_t> m_next;
+	size_t m_done;
+	boost::exception_ptr m_error; // the first exception thrown by a job
+	boost::mutex m_mutex;
+	boost::condition_variable m_done_cond;
+	void failed() {
+		const boost::lock_guard<boost::mutex> lock( m_mutex );
+
+		if( !m_error )
+			m_error = boost::current_exception();
+	}
+public:
+	JobBatch( const boost::function<void( size_t )> &job, size_t count ): m_job( job ), m_count( count ), m_next( 0 ), m_done( 0 ) {}
+	void work() {
+		for( size_t i = m_next++; i < m_count; i = m_next++ ) {
+			try {
+				m_job( i );
+			} catch( std::exception &e ) {
+				LOG( Runtime, error ) << "Uncaught exception in parallel job " << i << " (" << e.what() << ")";
+				failed();
+			} catch( ... ) { // the job still has to be counted as done, or wait() would never return
+				LOG( Runtime, error ) << "Uncaught unknown exception in parallel job " << i;
+				failed();
+			}
+
+			const boost::lock_guard<boost::mutex> lock( m_mutex );
+
+			if( ++m_done == m_count )
+				m_done_cond.notify_all();
+		}
+	}
+	void wait() {
+		boost::unique_lock<boost::mutex> lock( m_mutex );
+
+		while( m_done < m_count )
+			m_done_cond.wait( lock );
+	}
+	// must only be called after wait()
+	void rethrow() {
+		if( m_error )
+			boost::rethrow_exception( m_error );
+	}
+};
+}
+/// @endcond _internal
+
+ThreadPool::ThreadPool( size_t threads ): m_pending( 0 ), m_stop( false )
+{
+	if( threads == 0 )
+		threads = hardwareThreads();
+
+	for( size_t i = 0; i < threads; i++ )
+		m_workers.create_thread( boost::bind( &ThreadPool::worker, this ) );
+
+	LOG( Debug, info ) << "Started thread pool with " << threads << " workers";
+}
+
+ThreadPool::~ThreadPool()
+{
+	wait();
+	{
+		const boost::lock_guard<boost::mutex> lock( m_mutex );
+		m_stop = true;
+	}
+	m_task_cond.notify_all();
+	m_workers.join_all();
+}
+
+void ThreadPool::post( const Task &task )
+{
+	{
+		const boost::lock_guard<boost::mutex> lock( m_mutex );
+		m_queue.push_back( task );
+		m_pending++;
+	}
+	m_task_cond.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	boost::unique_lock<boost::mutex> lock( m_mutex );
+
+	while( m_pending )
+		m_done_cond.wait( lock );
+}
+
+void ThreadPool::parallelFor( size_t count, const boost::function<void( size_t )> &job )
+{
+	if( count == 0 )
+		return;
+
+	const boost::shared_ptr<_internal::JobBatch> batch( new _internal::JobBatch( job, count ) );
+	const size_t helpers = std::min( threads(), count - 1 ); // the calling thread does one part itself
+
+	for( size_t i = 0; i < helpers; i++ )
+		post( boost::bind( &_internal::JobBatch::work, batch ) );
+
+	batch->work();
+	batch->wait(); // for the jobs still running in the workers
+	batch->rethrow();
+}
+
+size_t ThreadPool::threads()const
+{
+	return m_workers.size();
+}
+
+size_t ThreadPool::hardwareThreads()
+{
+	const size_t ret = boost::thread::hardware_concurrency();
+	return ret ? ret : 1;
+}
+
+ThreadPool &ThreadPool::shared()
+{
+	return Singletons::get<ThreadPool, 0>();
+}
+
+void ThreadPool::worker()
+{
+	while( true ) {
+		Task task;
+		{
+			boost::unique_lock<boost::mutex> lock( m_mutex );
+
+			while( m_queue.empty() && !m_stop )
+				m_task_cond.wait( lock );
+
+			if( m_queue.empty() ) // m_stop is set and there is nothing left to do
+				return;
+
+			task.swap( m_queue.front() );
+			m_queue.pop_front();
+		}
+
+		try {
+			task();
+		} catch( std::exception &e ) {
+			LOG( Runtime, error ) << "Uncaught exception in worker thread (" << e.what() << ")";
+		} catch( ... ) { // whatever it is, it must not kill the worker or keep wait() from returning
+			LOG( Runtime, error ) << "Uncaught unknown exception in worker thread";
+		}
+
+		const boost::lock_guard<boost::mutex> lock( m_mutex );
+
+		if( --m_pending == 0 )
+			m_done_cond.notify_all();
+	}
+}
+
+}
+}
@@ -0,0 +1,86 @@
+/*
+    Copyright (C) 2010  reimer@cbs.mpg.de
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <deque>
+#include <stddef.h>
+#include <boost/noncopyable.hpp>
+#include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace isis
+{
+namespace util
+{
+/**
+ * Simple fixed size pool of worker threads.
+ * Tasks are posted into a FIFO queue and executed by the first free worker.
+ * wait() blocks until every task posted so far is done, so the pool can be reused for multiple batches.
+ * \note Tasks must not wait() on the pool they are running in - this would deadlock if all workers do so.
+ */
+class ThreadPool: boost::noncopyable
+{
+public:
+	typedef boost::function<void()> Task;
+	/**
+	 * Create a pool and start its workers.
+	 * \param threads the amount of worker threads (0 means one per available cpu core)
+	 */
+	explicit ThreadPool( size_t threads = 0 );
+	/// Waits for all pending tasks and stops the workers.
+	~ThreadPool();
+	/// Add a task to the queue. It will be run by the next free worker.
+	void post( const Task &task );
+	/// Block until all tasks posted so far are finished.
+	void wait();
+	/**
+	 * Run job(0) .. job(count-1) using the workers of the pool and the calling thread.
+	 * Returns when all jobs are done. Jobs are started in ascending order, but may run concurrently.
+	 * As the calling thread also does work, this can be safely used from within a task of the same pool.
+	 * If jobs throw, the remaining jobs are still run. The first exception is rethrown once all jobs are done.
+	 * Types which boost::current_exception cannot copy are rethrown as boost::unknown_exception.
+	 * \param count the amount of jobs
+	 * \param job the function to be called for every index (must be safe to be called concurrently)
+	 */
+	void parallelFor( size_t count, const boost::function<void( size_t )> &job );
+	/// \returns the amount of worker threads of this pool
+	size_t threads()const;
+	/// \returns the amount of concurrent threads supported by the machine (at least 1)
+	static size_t hardwareThreads();
+	/**
+	 * Get the pool shared by the parallel operations of Core.
+	 * It is created on first use with one worker per cpu core.
+	 */
+	static ThreadPool &shared();
+private:
+	void worker();
+	std::deque<Task> m_queue;
+	size_t m_pending; // tasks queued or currently running
+	bool m_stop;
+	boost::mutex m_mutex;
+	boost::condition_variable m_task_cond, m_done_cond;
+	boost::thread_group m_workers;
+};
+}
+}
+
+#endif // THREADPOOL_HPP
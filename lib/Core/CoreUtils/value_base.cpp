@@ -38,11 +38,7 @@ const _internal::ValueConverterMap &ValueBase::converters()
 
 const ValueBase::Converter &ValueBase::getConverterTo( unsigned short ID )const
 {
-	const _internal::ValueConverterMap::const_iterator f1 = converters().find( getTypeID() );
-	assert( f1 != converters().end() );
-	const _internal::ValueConverterMap::mapped_type::const_iterator f2 = f1->second.find( ID );
-	assert( f2 != f1->second.end() );
-	return f2->second;
+	return converters().get( getTypeID(), ID );
 }
 bool ValueBase::convert( const ValueBase &from, ValueBase &to )
 {
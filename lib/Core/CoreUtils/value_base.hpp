@@ -80,7 +80,7 @@ protected:
 	virtual ValueBase *clone()const = 0;
 public:
 	typedef _internal::GenericReference<ValueBase> Reference;
-	typedef _internal::ValueConverterMap::mapped_type::mapped_type Converter;
+	typedef _internal::ValueConverterMap::Converter Converter;
 
 	/// \return true is the stored type is T
 	template<typename T> bool is()const;
@@ -115,15 +115,15 @@ public:
 		if( is<T>() )
 			return castTo<T>();
 
-		Reference ret = copyByID( Value<T>::staticID );
+		Value<T> ret; // converting into a value on the stack avoids the allocation done by copyByID
 
-		if ( ret.isEmpty() ) {
+		if ( !convert( *this, ret ) ) {
 			LOG( Debug, error )
 					<< "Interpretation of " << toString( true ) << " as " << Value<T>::staticName()
-					<< " failed. Returning " << Value<T>().toString() << ".";
-			return T();
-		} else
-			return ret->castTo<T>();
+					<< " failed. Returning " << ret.toString() << ".";
+		}
+
+		return ret;
 	}
 
 	/**
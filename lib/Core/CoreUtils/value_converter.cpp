@@ -27,6 +27,7 @@
 #include <boost/mpl/for_each.hpp>
 #include <boost/type_traits/is_arithmetic.hpp>
 #include <boost/mpl/and.hpp>
+#include <boost/mpl/size.hpp>
 
 // @todo we need to know this for lexical_cast (toString)
 #include <boost/date_time/gregorian/gregorian.hpp>
@@ -757,36 +758,49 @@ public:
 
 ///generate a ValueConverter for conversions from SRC to any type from the "types" list
 template<typename SRC> struct inner_TypeConverter {
-	std::map<int, boost::shared_ptr<const ValueConverterBase> > &m_subMap;
-	inner_TypeConverter( std::map<int, boost::shared_ptr<const ValueConverterBase> > &subMap ): m_subMap( subMap ) {}
+	ValueConverterMap &m_map;
+	inner_TypeConverter( ValueConverterMap &map ): m_map( map ) {}
 	template<typename DST> void operator()( DST ) { //will be called by the mpl::for_each in outer_TypeConverter for any DST out of "types"
 		//create a converter based on the type traits and the types of SRC and DST
 		typedef boost::mpl::and_<boost::is_arithmetic<SRC>, boost::is_arithmetic<DST> > is_num;
 		typedef boost::is_same<SRC, DST> is_same;
 		boost::shared_ptr<const ValueConverterBase> conv =
 			ValueConverter<is_num::value, is_same::value, SRC, DST>::get();
-		//and insert it into the to-conversion-map of SRC
-		m_subMap.insert( m_subMap.end(), std::make_pair( Value<DST>::staticID, conv ) );
+		//and insert it into the table
+		m_map.set( Value<SRC>::staticID, Value<DST>::staticID, conv );
 	}
 };
 
 ///generate a ValueConverter for conversions from any SRC from the "types" list
 struct outer_TypeConverter {
-	std::map< int , std::map<int, boost::shared_ptr<const ValueConverterBase> > > &m_map;
-	outer_TypeConverter( std::map< int , std::map<int, boost::shared_ptr<const ValueConverterBase> > > &map ): m_map( map ) {}
+	ValueConverterMap &m_map;
+	outer_TypeConverter( ValueConverterMap &map ): m_map( map ) {}
 	template<typename SRC> void operator()( SRC ) {//will be called by the mpl::for_each in ValueConverterMap() for any SRC out of "types"
 		boost::mpl::for_each<types>( // create a functor for from-SRC-conversion and call its ()-operator for any DST out of "types"
-			inner_TypeConverter<SRC>( m_map[Value<SRC>().getTypeID()] )
+			inner_TypeConverter<SRC>( m_map )
 		);
 	}
 };
 
-ValueConverterMap::ValueConverterMap()
+// the type IDs start at 1 and are the position in "types", so the biggest ID is the size of "types"
+ValueConverterMap::ValueConverterMap(): m_size( boost::mpl::size<types>::value + 1 )
 {
+	m_table.resize( m_size * m_size );
 	boost::mpl::for_each<types>( outer_TypeConverter( *this ) );
 	LOG( Debug, info ) << "conversion map for " << size() << " types created";
 }
 
+void ValueConverterMap::set( unsigned short src, unsigned short dst, const Converter &conv )
+{
+	assert( src < m_size && dst < m_size );
+	m_table[src * m_size + dst] = conv;
+}
+
+size_t ValueConverterMap::size()const
+{
+	return m_size - 1;
+}
+
 }
 API_EXCLUDE_END;
 }
@@ -20,6 +20,8 @@
 #ifndef CONVERTER_HPP
 #define CONVERTER_HPP
 
+#include <vector>
+#include <assert.h>
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
 #include <boost/numeric/conversion/converter.hpp>
@@ -47,10 +49,27 @@ public:
 };
 
 API_EXCLUDE_BEGIN;
-class ValueConverterMap : public std::map< int , std::map<int, boost::shared_ptr<const ValueConverterBase> > >
+/**
+ * Table of the converters between all types.
+ * Its dense and indexed by the IDs of source and destination type, so looking up a converter is just an array access.
+ */
+class ValueConverterMap
 {
 public:
+	typedef boost::shared_ptr<const ValueConverterBase> Converter;
 	ValueConverterMap();
+	/// \returns the converter from the type with the ID src to the type with the ID dst (an empty pointer if there is none)
+	const Converter &get( unsigned short src, unsigned short dst )const {
+		assert( src < m_size && dst < m_size );
+		return m_table[src * m_size + dst];
+	}
+	/// set the converter from the type with the ID src to the type with the ID dst
+	void set( unsigned short src, unsigned short dst, const Converter &conv );
+	/// \returns the amount of source types
+	size_t size()const;
+private:
+	std::vector<Converter> m_table; // the converter from a to b is at a*m_size+b
+	unsigned short m_size; // the biggest type ID plus one
 };
 
 }
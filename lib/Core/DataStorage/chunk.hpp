@@ -19,10 +19,15 @@
 #include "common.hpp"
 #include <string.h>
 #include <list>
+#include <vector>
+#include <algorithm>
 #include "ndimensional.hpp"
 #include "../CoreUtils/vector.hpp"
+#include "../CoreUtils/threadpool.hpp"
 
 #include <boost/numeric/ublas/matrix.hpp>
+#include <boost/utility/enable_if.hpp>
+#include <boost/type_traits/is_base_of.hpp>
 
 namespace isis
 {
@@ -57,6 +62,136 @@ public:
 	virtual ~VoxelOp() {}
 };
 
+/**
+ * Base class for operators used for the parallel foreachVoxel.
+ * The voxels are processed by multiple threads, each of them working on its own clone of the operator.
+ * When all voxels are done, every clone is handed to join() of the original operator and deleted afterwards.
+ * So operators accumulating some state (e.g. a sum) can merge the partial results there.
+ */
+template <typename TYPE> class ParallelVoxelOp: public VoxelOp<TYPE>
+{
+public:
+	/// \returns a new copy of the operator to be used by one thread
+	virtual ParallelVoxelOp<TYPE> *clone()const = 0;
+	/// Merge the state of a clone into this operator (does nothing by default).
+	virtual void join( ParallelVoxelOp<TYPE> &/*clone*/ ) {}
+};
+
+/// @cond _internal
+namespace _internal
+{
+// stores the result of one clone for runParallelOp
+template<typename OP> struct ParallelOpSlot {
+	boost::shared_ptr<OP> op;
+	size_t errors;
+	ParallelOpSlot(): errors( 0 ) {}
+};
+
+// one thread taking part in runParallelOp - takes jobs from the shared counter until all are done
+// so faster threads just take more jobs
+template<typename OP, typename JOB> struct ParallelOpWorker {
+	const OP &original;
+	const JOB &job;
+	const size_t count;
+	boost::atomic<size_t> &next;
+	std::vector<ParallelOpSlot<OP> > &slots;
+	ParallelOpWorker( const OP &_original, const JOB &_job, size_t _count, boost::atomic<size_t> &_next, std::vector<ParallelOpSlot<OP> > &_slots ):
+		original( _original ), job( _job ), count( _count ), next( _next ), slots( _slots ) {}
+	void operator()( size_t slot )const {
+		ParallelOpSlot<OP> &my = slots[slot];
+
+		try {
+			my.op.reset( original.clone() );
+
+			for( size_t i = next++; i < count; i = next++ )
+				my.errors += job( *my.op, i );
+		} catch( ... ) {
+			next = count; // no need for the others to start new jobs, the result will be thrown away anyway
+			throw;
+		}
+	}
+};
+
+/**
+ * Run job(clone, 0) .. job(clone, count-1) using the shared thread pool.
+ * Every thread taking part uses its own clone of op, which is joined into op when all jobs are done.
+ * If clone() or any job throws, the remaining jobs are skipped, nothing is joined, and the first exception is rethrown.
+ * \returns the sum of the values returned by job
+ */
+template<typename OP, typename JOB> size_t runParallelOp( OP &op, const JOB &job, size_t count )
+{
+	if( count == 0 )
+		return 0;
+
+	util::ThreadPool &pool = util::ThreadPool::shared();
+	std::vector<ParallelOpSlot<OP> > slots( std::min( pool.threads() + 1, count ) );
+	boost::atomic<size_t> next( 0 );
+	pool.parallelFor( slots.size(), ParallelOpWorker<OP, JOB>( op, job, count, next, slots ) ); // rethrows if any slot failed
+
+	size_t errors = 0;
+
+	for( typename std::vector<ParallelOpSlot<OP> >::iterator i = slots.begin(); i != slots.end(); ++i ) {
+		op.join( *i->op );
+		errors += i->errors;
+	}
+
+	return errors;
+}
+
+// splits the voxels of typed chunks into blocks of whole rows for the parallel foreachVoxel
+template<typename TYPE> class VoxelBlockJob
+{
+	struct Part {
+		mutable ValueArray<TYPE> data;
+		util::vector4<size_t> size, offset;
+		size_t rows_per_block, first_block;
+		Part( const ValueArray<TYPE> &_data, const util::vector4<size_t> &_size, const util::vector4<size_t> &_offset ):
+			data( _data ), size( _size ), offset( _offset ), first_block( 0 ) {
+			rows_per_block = std::max<size_t>( 1, voxels_per_block / size[rowDim] );
+		}
+		size_t rows()const {return size[columnDim] * size[sliceDim] * size[timeDim];}
+		size_t blocks()const {return ( rows() + rows_per_block - 1 ) / rows_per_block;}
+	};
+	std::vector<Part> parts;
+	static bool beforeBlock( size_t block, const Part &part ) {return block < part.first_block;}
+public:
+	static const size_t voxels_per_block = 16384;
+	void add( const ValueArray<TYPE> &data, const util::vector4<size_t> &size, const util::vector4<size_t> &offset ) {
+		const size_t first = blocks();
+		parts.push_back( Part( data, size, offset ) );
+		parts.back().first_block = first;
+	}
+	size_t blocks()const {
+		return parts.empty() ? 0 : parts.back().first_block + parts.back().blocks();
+	}
+	size_t operator()( VoxelOp<TYPE> &op, size_t block )const {
+		// the last part starting at or before block (parts are sorted by first_block)
+		const typename std::vector<Part>::const_iterator part = std::upper_bound( parts.begin(), parts.end(), block, beforeBlock ) - 1;
+
+		const size_t first_row = ( block - part->first_block ) * part->rows_per_block;
+		const size_t end_row = std::min( first_row + part->rows_per_block, part->rows() );
+		TYPE *vox = &part->data[first_row * part->size[rowDim]];
+		size_t ret = 0;
+
+		for( size_t r = first_row; r < end_row; r++ ) {
+			util::vector4<size_t> pos;
+			pos[columnDim] = r % part->size[columnDim];
+			pos[sliceDim] = ( r / part->size[columnDim] ) % part->size[sliceDim];
+			pos[timeDim] = r / ( part->size[columnDim] * part->size[sliceDim] );
+			pos = pos + part->offset;
+
+			for( size_t c = 0; c < part->size[rowDim]; c++, pos[rowDim]++ ) {
+				if( op( *( vox++ ), pos ) == false )
+					++ret;
+			}
+		}
+
+		return ret;
+	}
+};
+}
+/// @endcond _internal
+
 /**
  * Main class for four-dimensional random-access data blocks.
  * Like in ValueArray, the copy of a Chunk will reference the same data. (cheap copy)
@@ -80,6 +215,25 @@ protected:
 		_internal::ChunkBase( nrOfColumns, nrOfRows, nrOfSlices, nrOfTimesteps ), ValueArrayReference( ValueArray<TYPE>( src, getVolume(), d ) ) {}
 
 	Chunk() {}; //do not use this
+
+	// the loop of all foreachVoxel - offset is added only once, and the position is just incremented
+	template<typename TYPE, typename OP> size_t foreachVoxelImpl( OP &op, const util::vector4<size_t> &offset ) {
+		const util::vector4<size_t> end = getSizeAsVector() + offset;
+		util::vector4<size_t> pos;
+		const util::vector4<size_t> &cpos = pos; // op must not change the position
+		TYPE *vox = &asValueArray<TYPE>()[0];
+		size_t ret = 0;
+
+		for( pos[timeDim] = offset[timeDim]; pos[timeDim] < end[timeDim]; pos[timeDim]++ )
+			for( pos[sliceDim] = offset[sliceDim]; pos[sliceDim] < end[sliceDim]; pos[sliceDim]++ )
+				for( pos[columnDim] = offset[columnDim]; pos[columnDim] < end[columnDim]; pos[columnDim]++ )
+					for( pos[rowDim] = offset[rowDim]; pos[rowDim] < end[rowDim]; pos[rowDim]++ ) {
+						if( op( *( vox++ ), cpos ) == false )
+							++ret;
+					}
+
+		return ret;
+	}
 public:
 
 	typedef ValueArrayBase::value_iterator iterator;
@@ -134,20 +288,7 @@ public:
 	 * \returns amount of operations which returned false - so 0 is good!
 	 */
 	template <typename TYPE> size_t foreachVoxel( VoxelOp<TYPE> &op, util::vector4<size_t> offset ) {
-		const util::vector4<size_t> imagesize = getSizeAsVector();
-		util::vector4<size_t> pos;
-		TYPE *vox = &asValueArray<TYPE>()[0];
-		size_t ret = 0;
-
-		for( pos[timeDim] = 0; pos[timeDim] < imagesize[timeDim]; pos[timeDim]++ )
-			for( pos[sliceDim] = 0; pos[sliceDim] < imagesize[sliceDim]; pos[sliceDim]++ )
-				for( pos[columnDim] = 0; pos[columnDim] < imagesize[columnDim]; pos[columnDim]++ )
-					for( pos[rowDim] = 0; pos[rowDim] < imagesize[rowDim]; pos[rowDim]++ ) {
-						if( op( *( vox++ ), pos + offset ) == false )
-							++ret;
-					}
-
-		return ret;
+		return foreachVoxelImpl<TYPE>( op, offset );
 	}
 
 	/**
@@ -159,6 +300,69 @@ public:
 		return foreachVoxel<TYPE>( op, util::vector4<size_t>() );
 	}
 
+	/**
+	 * Run any callable on every Voxel in the chunk.
+	 * Other than with VoxelOp, op is not called virtually, so simple operations can be inlined by the compiler.
+	 * TYPE cannot be deduced and must be given explicitly (e.g. ch.foreachVoxel\<float\>( op ) ).
+	 * If the data of the chunk are not of type TYPE, behaviour is undefined.
+	 * \param op a callable which can be called as bool op( TYPE &vox, const util::vector4\<size_t\> &pos )
+	 * \param offset offset to be added to the voxel position before op is called
+	 * \returns amount of operations which returned false - so 0 is good!
+	 */
+	template <typename TYPE, typename OP> typename boost::disable_if<boost::is_base_of<VoxelOp<TYPE>, OP>, size_t>::type
+	foreachVoxel( OP &op, util::vector4<size_t> offset = util::vector4<size_t>() ) {
+		return foreachVoxelImpl<TYPE>( op, offset );
+	}
+
+	/**
+	 * Run any callable on the value of every Voxel in the chunk.
+	 * This just runs through the memory of the chunk without computing the voxel position.
+	 * So for simple operations the compiler can inline and vectorise the loop.
+	 * If the data of the chunk are not of type TYPE, behaviour is undefined.
+	 * \param op a callable which can be called as op( TYPE &vox ) - its return value is ignored
+	 * \returns a copy of op after it was called for all voxels (like std::for_each)
+	 */
+	template <typename TYPE, typename OP> OP foreachValue( OP op ) {
+		TYPE *const start = &asValueArray<TYPE>()[0];
+		TYPE *const end = start + getVolume();
+
+		for( TYPE *vox = start; vox != end; ++vox )
+			op( *vox );
+
+		return op;
+	}
+
+	/**
+	 * Run a functor on every Voxel in the chunk using multiple threads.
+	 * The voxels are split into blocks of rows, which are processed by clones of op (see ParallelVoxelOp).
+	 * So the order in which the voxels are visited is undefined.
+	 * If the data of the chunk are not of type TYPE, behaviour is undefined.
+	 * If the resolved policy is not parallel_execution, op itself is run on all voxels in the calling thread.
+	 * If op (or its clone()) throws, the first exception is rethrown once all threads stopped.
+	 * \param op a functor inheriting from ParallelVoxelOp
+	 * \param offset offset to be added to the voxel position before op is called
+	 * \param policy parallel_execution to process multiple blocks of voxels at once (see data::setExecutionPolicy)
+	 * \returns amount of operations which returned false - so 0 is good!
+	 */
+	template <typename TYPE> size_t foreachVoxel( ParallelVoxelOp<TYPE> &op, util::vector4<size_t> offset, execution_policy policy = default_execution ) {
+		if( resolveExecutionPolicy( policy ) != parallel_execution )
+			return foreachVoxelImpl<TYPE>( static_cast<VoxelOp<TYPE>&>( op ), offset );
+
+		_internal::VoxelBlockJob<TYPE> job;
+		job.add( asValueArray<TYPE>(), getSizeAsVector(), offset );
+		return _internal::runParallelOp( op, job, job.blocks() );
+	}
+
+	/**
+	 * Run a functor on every Voxel in the chunk using multiple threads.
+	 * \param op a functor inheriting from ParallelVoxelOp
+	 * \param policy parallel_execution to process multiple blocks of voxels at once (see data::setExecutionPolicy)
+	 * \returns amount of operations which returned false - so 0 is good!
+	 */
+	template<typename TYPE> size_t foreachVoxel( ParallelVoxelOp<TYPE> &op, execution_policy policy = default_execution ) {
+		return foreachVoxel<TYPE>( op, util::vector4<size_t>(), policy );
+	}
+
 	iterator begin();
 	iterator end();
 	const_iterator begin()const;
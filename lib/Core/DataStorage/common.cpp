@@ -13,6 +13,7 @@
 #include "common.hpp"
 #include "image.hpp"
 #include <boost/numeric/ublas/io.hpp>
+#include <boost/atomic.hpp>
 
 namespace isis
 {
@@ -22,7 +23,10 @@ namespace data
 
 namespace _internal
 {
-
+namespace
+{
+boost::atomic<execution_policy> defaultExecutionPolicy( sequential_execution );
+}
 
 bool transformCoords( isis::util::PropertyMap &properties, util::vector4<size_t> size, boost::numeric::ublas::matrix<float> transform, bool transformCenterIsImageCenter  )
 {
@@ -137,6 +141,22 @@ bool transformCoords( isis::util::PropertyMap &properties, util::vector4<size_t>
 
 }
 
+void setExecutionPolicy( execution_policy policy )
+{
+	LOG_IF( policy == default_execution, Debug, warning ) << "Ignoring default_execution as default execution policy";
+
+	if( policy != default_execution )
+		_internal::defaultExecutionPolicy = policy;
+}
+execution_policy getExecutionPolicy()
+{
+	return _internal::defaultExecutionPolicy;
+}
+execution_policy resolveExecutionPolicy( execution_policy policy )
+{
+	return policy == default_execution ? getExecutionPolicy() : policy;
+}
+
 boost::filesystem::path getCommonSource( std::list<boost::filesystem::path> sources )
 {
 	sources.erase( std::unique( sources.begin(), sources.end() ), sources.end() );
@@ -67,6 +67,25 @@ typedef DataLog Runtime;
 typedef DataDebug Debug;
 enum dimensions {rowDim = 0, columnDim, sliceDim, timeDim};
 enum scannerAxis { x = 0, y, z, t };
+/**
+ * How operations which can be split into independent parts (e.g. the conversion of the chunks of an image) are run.
+ * - default_execution: use the global default (see setExecutionPolicy)
+ * - sequential_execution: do all parts in the calling thread
+ * - parallel_execution: distribute the parts over the calling thread and the workers of util::ThreadPool::shared()
+ */
+enum execution_policy {default_execution, sequential_execution, parallel_execution};
+
+/**
+ * Set the execution policy used when default_execution is requested.
+ * This applies to Image::convertToType, Image::copyByID, the construction of TypedImage and MemImage,
+ * Image::foreachChunk, Image::foreachVoxel and to the conversion of big ValueArray's.
+ * The initial policy is sequential_execution. It can be changed at any time from any thread.
+ */
+void setExecutionPolicy( execution_policy policy );
+/// \returns the execution policy used when default_execution is requested
+execution_policy getExecutionPolicy();
+/// \returns the given policy, or the global one (see setExecutionPolicy) if it is default_execution
+execution_policy resolveExecutionPolicy( execution_policy policy );
 
 /**
  * Set logging level for the namespace data.
@@ -17,6 +17,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <boost/mpl/for_each.hpp>
+#include <algorithm>
 #include "../CoreUtils/singletons.hpp"
 
 // we need that, because boost::mpl::for_each will instantiate all types - and this needs the output stream operations
@@ -81,8 +82,8 @@ void FilePtr::Closer::operator()( void *p )
 
 FilePtr::GeneratorMap::GeneratorMap()
 {
-	boost::mpl::for_each<util::_internal::types>( proc( this ) );
-	assert( !empty() );
+	std::fill( m_table, m_table + size, generator_type( NULL ) );
+	boost::mpl::for_each<util::_internal::types>( proc( m_table ) );
 }
 
 
@@ -198,9 +199,7 @@ ValueArrayReference FilePtr::atByID( short unsigned int ID, size_t offset, size_
 {
 	LOG_IF( static_cast<boost::shared_ptr<uint8_t>&>( *this ).get() == 0, Debug, error )
 			<< "There is no mapped data for this FilePtr - I'm very likely gonna crash soon ..";
-	GeneratorMap &map = util::Singletons::get<GeneratorMap, 0>();
-	assert( !map.empty() );
-	const generator_type gen = map[ID];
+	const generator_type gen = util::Singletons::get<GeneratorMap, 0>()[ID];
 	assert( gen );
 	return gen( *this, offset, len, swap_endianess );
 }
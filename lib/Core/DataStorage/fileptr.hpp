@@ -12,6 +12,7 @@
 #define BOOST_FILESYSTEM_VERSION 3 
 #include <boost/filesystem.hpp>
 #include <boost/detail/endian.hpp>
+#include <boost/mpl/size.hpp>
 #include "valuearray.hpp"
 #include "endianess.hpp"
 
@@ -45,16 +46,23 @@ class FilePtr: public ValueArray<uint8_t>
 		void operator()( void *p );
 	};
 	typedef data::ValueArrayReference( *generator_type )( data::FilePtr &, size_t, size_t, bool );
-	struct GeneratorMap: public std::map<unsigned short, generator_type> {
+	// dense table of the generators indexed by the ID of the ValueArray type (which is the ID of the Value type shifted by 8)
+	struct GeneratorMap {
+		enum {size = boost::mpl::size<util::_internal::types>::value + 1};
+		generator_type m_table[size];
 		GeneratorMap();
+		/// \returns the generator for the ValueArray type with the given ID (NULL if it is unknown)
+		generator_type operator[]( unsigned short ID )const {
+			return ( ID >> 8 ) < size ? m_table[ID >> 8] : NULL;
+		}
 		template<class T> static data::ValueArrayReference generator( data::FilePtr &mfile, size_t offset, size_t len, bool swap_endianess ) {
 			return mfile.at<T>( offset, len, swap_endianess );
 		}
 		struct proc {
-			std::map<unsigned short, generator_type> *m_map;
-			proc( std::map<unsigned short, generator_type> *map ): m_map( map ) {}
+			generator_type *m_table;
+			proc( generator_type *table ): m_table( table ) {}
 			template<class T> void operator()( const T & ) {
-				m_map->insert( std::make_pair( ValueArray<T>::staticID, &generator<T> ) );
+				m_table[ValueArray<T>::staticID >> 8] = &generator<T>;
 			}
 		};
 	};
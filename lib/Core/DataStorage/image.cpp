@@ -17,6 +17,7 @@
 #endif
 
 #include "image.hpp"
+#include "../CoreUtils/threadpool.hpp"
 #include "../CoreUtils/vector.hpp"
 #include <boost/foreach.hpp>
 #include "../CoreUtils/property.hpp"
@@ -32,6 +33,66 @@ namespace data
 {
 
 ChunkOp::~ChunkOp() {}
+void ParallelChunkOp::join( ParallelChunkOp &/*clone*/ ) {}
+
+/// @cond _internal
+namespace _internal
+{
+// converts the chunks of a lookup table backwards (see Image::convertToType)
+struct ChunkConvertJob {
+	std::vector<boost::shared_ptr<Chunk> > &chunks;
+	const unsigned short ID;
+	const scaling_pair &scale;
+	std::vector<uint8_t> &results; // not vector<bool> because that cannot be written concurrently
+	ChunkConvertJob( std::vector<boost::shared_ptr<Chunk> > &_chunks, unsigned short _ID, const scaling_pair &_scale, std::vector<uint8_t> &_results ):
+		chunks( _chunks ), ID( _ID ), scale( _scale ), results( _results ) {}
+	void operator()( size_t i ) {
+		const size_t at = chunks.size() - 1 - i;
+		results[at] = chunks[at]->convertToType( ID, scale );
+	}
+};
+
+// runs a ParallelChunkOp on one of the chunks collected by Image::collectChunks
+struct ParallelChunkJob {
+	std::vector<Chunk> &chunks;
+	const std::vector<util::vector4<size_t> > &positions;
+	ParallelChunkJob( std::vector<Chunk> &_chunks, const std::vector<util::vector4<size_t> > &_positions ): chunks( _chunks ), positions( _positions ) {}
+	size_t operator()( ParallelChunkOp &op, size_t i )const {
+		return op( chunks[i], positions[i] ) ? 0 : 1;
+	}
+};
+
+// -0 is equal to 0 for the properties, so they must give the same group key (and so should all NaNs)
+template<typename T> T normalizeFloat( T val )
+{
+	if( val != val )
+		return std::numeric_limits<T>::quiet_NaN();
+	else
+		return val == 0 ? 0 : val;
+}
+template<typename T> bool normalizeScalar( util::PropertyValue &val )
+{
+	if( !val.is<T>() )
+		return false;
+
+	T &ref = val.castTo<T>();
+	ref = normalizeFloat( ref );
+	return true;
+}
+template<typename VEC> bool normalizeVector( util::PropertyValue &val )
+{
+	if( !val.is<VEC>() )
+		return false;
+
+	VEC &ref = val.castTo<VEC>();
+
+	for( typename VEC::iterator i = ref.begin(); i != ref.end(); ++i )
+		*i = normalizeFloat( *i );
+
+	return true;
+}
+}
+/// @endcond _internal
 
 Image::Image ( ) : set( defaultChunkEqualitySet ), clean( false )
 {
@@ -53,6 +114,30 @@ Image::Image ( const Chunk &chunk, dimensions min_dim ) :
 	}
 }
 
+Image::Image ( std::vector<Chunk> &chunks, dimensions min_dim ) :
+	_internal::NDimensional<4>(), util::PropertyMap(), minIndexingDim( min_dim ), set( defaultChunkEqualitySet ), clean( false )
+{
+	util::Singletons::get<NeededsList<Image>, 0>().applyTo( *this );
+	set.addSecondarySort( "acquisitionNumber" );
+	indexInsertedChunks( set.insertBulk( chunks ) );
+}
+
+void Image::indexInsertedChunks( size_t cnt )
+{
+	if ( ! isEmpty() ) {
+		LOG( Debug, info ) << "Reindexing image with " << cnt << " chunks.";
+
+		if ( !reIndex() ) {
+			LOG( Runtime, error ) << "Failed to create image from " << cnt << " chunks.";
+		} else {
+			LOG_IF( !getMissing().empty(), Debug, warning )
+					<< "The created image is missing some properties: " << getMissing() << ". It will be invalid.";
+		}
+	} else {
+		LOG( Debug, warning ) << "Image is empty after inserting chunks.";
+	}
+}
+
 Image::Image( const data::Image &ref ): _internal::NDimensional<4>(), util::PropertyMap(),
 	set( "" )/*SortedChunkList has no default constructor - lets just make an empty (and invalid) set*/
 {
@@ -173,6 +258,81 @@ bool Image::insertChunk ( const Chunk &chunk )
 	}
 }
 
+bool Image::appendTimestep( const Chunk &chunk )
+{
+	if( !clean || lookup.size() != getNrOfTimesteps() ) {
+		LOG( Debug, info ) << "The image is not made of clean volumes, appending the chunk using insertChunk and reIndex.";
+		return insertChunk( chunk ) && reIndex();
+	}
+
+	if ( ! chunk.isValid() ) {
+		LOG( Runtime, error ) << "Cannot append invalid chunk. Missing properties: " << chunk.getMissing();
+		return false;
+	}
+
+	const util::PropertyMap::KeyList lists = chunk.findLists();
+
+	if( !lists.empty() ) {
+		LOG( Runtime, error ) << "Cannot append chunk with the property lists " << util::listToString( lists.begin(), lists.end(), ", " ) << ", use insertChunk instead.";
+		return false;
+	}
+
+	const boost::shared_ptr<Chunk> added = set.append( chunk );
+
+	if( !added ) {
+		LOG( Runtime, error ) << "Cannot append chunk as timestep " << lookup.size() << " (Size is " << chunk.getSizeAsString() << ") because it does not fit to the image.";
+		return false;
+	}
+
+	// do what deduplicateProperties would do, but only for the new chunk
+	const NeededsList<Image> &needed = util::Singletons::get<NeededsList<Image>, 0>();
+	const util::PropertyMap::KeyList common = getKeys();
+	BOOST_FOREACH( const util::PropertyMap::KeyType & key, common ) {
+		if( !added->hasProperty( key ) )
+			continue;
+
+		if( added->propertyValue( key ) == propertyValue( key ) ) {
+			added->remove( key );
+		} else if( std::find( needed.begin(), needed.end(), util::PropertyMap::PropPath( key ) ) == needed.end() ) { // not common anymore - move it down into the chunks
+			LOG( Debug, verbose_info ) << "Property " << key << " is not common anymore, moving it into the chunks";
+			BOOST_FOREACH( boost::shared_ptr<Chunk> &ref, lookup ) {
+				ref->propertyValue( key ) = propertyValue( key );
+			}
+			remove( key );
+		}
+	}
+
+	lookup.push_back( added );
+	util::vector4<size_t> size = getSizeAsVector();
+	size[timeDim]++;
+	init( size );
+	return true;
+}
+
+std::string Image::getChunkGroupKey( const Chunk &chunk )
+{
+	static const std::list<util::PropertyMap::KeyType> keys =
+		util::stringToList<util::PropertyMap::KeyType>( util::PropertyMap::KeyType( defaultChunkEqualitySet ), ',' );
+	static const std::list<util::PropertyMap::PropPath> equalProps( keys.begin(), keys.end() );
+	std::string ret = chunk.getSizeAsString();
+
+	BOOST_FOREACH( const util::PropertyMap::PropPath & ref, equalProps ) {
+		ret += '|';
+
+		// use the labeled string, because values of different type are never equal as property
+		if( chunk.hasProperty( ref ) ) {
+			util::PropertyValue val = chunk.propertyValue( ref ); // a deep copy
+
+			_internal::normalizeVector<util::fvector3>( val ) || _internal::normalizeVector<util::dvector3>( val ) ||
+			_internal::normalizeVector<util::fvector4>( val ) || _internal::normalizeVector<util::dvector4>( val ) ||
+			_internal::normalizeScalar<float>( val ) || _internal::normalizeScalar<double>( val );
+			ret += val.toString( true );
+		}
+	}
+
+	return ret;
+}
+
 void Image::setIndexingDim( dimensions d )
 {
 	minIndexingDim = d;
@@ -628,7 +788,7 @@ void Image::copyToValueArray( ValueArrayBase &dst, scaling_pair scaling ) const
 	}
 }
 
-Image Image::copyByID( short unsigned int ID, scaling_pair scaling ) const
+Image Image::copyByID( short unsigned int ID, scaling_pair scaling, execution_policy policy ) const
 {
 	Image ret( *this ); // ok we just cheap-copied the whole image
 
@@ -646,7 +806,7 @@ Image Image::copyByID( short unsigned int ID, scaling_pair scaling ) const
 
 	conv_op.ID = ID;
 
-	ret.set.transform ( conv_op );
+	ret.set.transform ( conv_op, resolveExecutionPolicy( policy ) );
 
 	if ( ret.isClean() ) {
 		ret.lookup = ret.set.getLookup(); // the lookup table still points to the old chunks
@@ -655,8 +815,7 @@ Image Image::copyByID( short unsigned int ID, scaling_pair scaling ) const
 		ret.reIndex();
 	}
 
-	return *this;
-
+	return ret;
 }
 
 std::vector< Chunk > Image::copyChunksToVector( bool copy_metadata )const
@@ -797,11 +956,13 @@ std::pair<util::ValueReference, util::ValueReference> Image::getMinMax () const
 std::pair< util::ValueReference, util::ValueReference > Image::getScalingTo( short unsigned int targetID, autoscaleOption scaleopt ) const
 {
 	LOG_IF( !clean, Debug, error ) << "You should run reIndex before running this";
-	std::pair<util::ValueReference, util::ValueReference> minmax = getMinMax();
 
 	BOOST_FOREACH( const boost::shared_ptr<const Chunk> &ref, lookup ) { //find a chunk which would be converted
 		if( targetID != ref->getTypeID() ) {
-			const scaling_pair scale = ref->getScalingTo( targetID, minmax, scaleopt );
+			// only do the min/max-pass over the whole image if the scaling actually depends on it
+			const scaling_pair scale = ref->getValueArrayBase().needsValueRange( targetID, scaleopt ) ?
+									   ref->getScalingTo( targetID, getMinMax(), scaleopt ) :
+									   ref->getScalingTo( targetID, scaleopt );
 			LOG_IF( scale.first.isEmpty() || scale.second.isEmpty(), Debug, error ) << "Returning an invalid scaling. This is bad!";
 			return scale; // and ask that for the scaling
 		}
@@ -904,6 +1065,16 @@ unsigned short Image::getMajorTypeID() const
 		return getChunk( 0 ).getTypeID();
 		break;
 	default:
+		{ // dont do the min/max-pass if all chunks have the same type, min and max would be of that type anyway
+			bool same = true;
+			BOOST_FOREACH( const boost::shared_ptr<const Chunk> &ref, lookup ) {
+				same &= ( ref->getTypeID() == lookup.front()->getTypeID() );
+			}
+
+			if( same )
+				return lookup.front()->getTypeID();
+		}
+
 		std::pair<util::ValueReference, util::ValueReference> minmax = getMinMax();
 		LOG( Debug, info ) << "Determining  datatype of image with the value range " << minmax;
 
@@ -930,7 +1101,7 @@ std::string Image::getMajorTypeName() const
 	return util::getTypeMap()[getMajorTypeID()];
 }
 
-bool Image::convertToType( short unsigned int ID, autoscaleOption scaleopt )
+bool Image::convertToType( short unsigned int ID, autoscaleOption scaleopt, execution_policy policy )
 {
 	bool retVal = true;
 	BOOST_FOREACH( boost::shared_ptr<Chunk> &ref, lookup ) {
@@ -944,12 +1115,19 @@ bool Image::convertToType( short unsigned int ID, autoscaleOption scaleopt )
 	scaling_pair scale = getScalingTo( ID, scaleopt );
 
 	LOG( Debug, info ) << "Computed scaling of the original image data: [" << scale << "]";
-	retVal = true;
 	//we want all chunks to be of type ID - so tell them
-	BOOST_FOREACH( boost::shared_ptr<Chunk> &ref, lookup ) {
-		retVal &= ref->convertToType( ID, scale );
+	//go backwards, so the chunks which were read last by the min/max-pass in getScalingTo are converted while they are still in the cache
+	std::vector<uint8_t> results( lookup.size() );
+	_internal::ChunkConvertJob job( lookup, ID, scale, results );
+
+	if( resolveExecutionPolicy( policy ) == parallel_execution ) {
+		util::ThreadPool::shared().parallelFor( lookup.size(), job );
+	} else {
+		for( size_t i = 0; i < lookup.size(); i++ )
+			job( i );
 	}
-	return retVal;
+
+	return std::find( results.begin(), results.end(), 0 ) == results.end();
 }
 
 size_t Image::spliceDownTo( dimensions dim )   //rowDim = 0, columnDim, sliceDim, timeDim
@@ -1016,6 +1194,29 @@ size_t Image::spliceDownTo( dimensions dim )   //rowDim = 0, columnDim, sliceDim
 	return lookup.size();
 }
 
+bool Image::collectChunks( std::vector<Chunk> &chunks, std::vector<util::vector4<size_t> > &positions, bool copyMetaData )
+{
+	if( !checkMakeClean() )
+		return false;
+
+	const util::vector4<size_t> imgSize = getSizeAsVector();
+	const util::vector4<size_t> chunkSize = getChunk( 0, 0, 0, 0 ).getSizeAsVector();
+	util::vector4<size_t> pos;
+
+	for( pos[timeDim] = 0; pos[timeDim] < imgSize[timeDim]; pos[timeDim] += chunkSize[timeDim] ) {
+		for( pos[sliceDim] = 0; pos[sliceDim] < imgSize[sliceDim]; pos[sliceDim] += chunkSize[sliceDim] ) {
+			for( pos[columnDim] = 0; pos[columnDim] < imgSize[columnDim]; pos[columnDim] += chunkSize[columnDim] ) {
+				for( pos[rowDim] = 0; pos[rowDim] < imgSize[rowDim]; pos[rowDim] += chunkSize[rowDim] ) {
+					chunks.push_back( getChunk( pos[rowDim], pos[columnDim], pos[sliceDim], pos[timeDim], copyMetaData ) );
+					positions.push_back( pos );
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
 size_t Image::foreachChunk( ChunkOp &op, bool copyMetaData )
 {
 	size_t err = 0;
@@ -1042,6 +1243,28 @@ size_t Image::foreachChunk( ChunkOp &op, bool copyMetaData )
 	return err;
 }
 
+size_t Image::foreachChunk( ParallelChunkOp &op, bool copyMetaData, execution_policy policy )
+{
+	std::vector<Chunk> chunks;
+	std::vector<util::vector4<size_t> > positions;
+
+	if( !collectChunks( chunks, positions, copyMetaData ) )
+		return 0;
+
+	const _internal::ParallelChunkJob job( chunks, positions );
+
+	if( resolveExecutionPolicy( policy ) != parallel_execution ) {
+		size_t err = 0;
+
+		for( size_t i = 0; i < chunks.size(); i++ )
+			err += job( op, i );
+
+		return err;
+	}
+
+	return _internal::runParallelOp( op, job, chunks.size() );
+}
+
 size_t Image::getNrOfColumns() const
 {
 	return getDimSize( data::rowDim );
@@ -24,6 +24,7 @@
 #include <boost/type_traits/remove_const.hpp>
 #include <stack>
 #include "sortedchunklist.hpp"
+#include "segments.hpp"
 #include "common.hpp"
 
 namespace isis
@@ -86,7 +87,14 @@ public:
 	{}
 
 	ThisType &operator++() {
-		return operator+= ( 1 );
+		if ( ch_idx < chunks.size() ) { // just step forward instead of the full computation in operator+=
+			// at the end of the last chunk ch_idx becomes chunks.size() and current_it stays at its end (this is end())
+			if ( ++current_it == chunks[ch_idx]->end() && ++ch_idx < chunks.size() )
+				current_it = chunks[ch_idx]->begin();
+
+			return *this;
+		} else
+			return operator+= ( 1 );
 	}
 	ThisType &operator--() {
 		return operator-= ( 1 );
@@ -182,6 +190,20 @@ public:
 	virtual ~ChunkOp();
 };
 
+/**
+ * Base class for operators used for the parallel foreachChunk.
+ * The chunks are processed by multiple threads, each of them working on its own clone of the operator.
+ * When all chunks are done, every clone is handed to join() of the original operator and deleted afterwards.
+ */
+class ParallelChunkOp : public ChunkOp
+{
+public:
+	/// \returns a new copy of the operator to be used by one thread
+	virtual ParallelChunkOp *clone()const = 0;
+	/// Merge the state of a clone into this operator (does nothing by default).
+	virtual void join( ParallelChunkOp &/*clone*/ );
+};
+
 /// Main class for generic 4D-images
 class Image:
 	public _internal::NDimensional<4>,
@@ -213,6 +235,14 @@ private:
 	size_t chunkVolume;
 
 	void deduplicateProperties();
+	/// reIndex the image after cnt chunks where inserted by one of the constructors
+	void indexInsertedChunks ( size_t cnt );
+
+	/**
+	 * Get cheap copies of all chunks of the image in the order foreachChunk would visit them.
+	 * \returns false if the image could not be made clean (chunks and positions will be empty then)
+	 */
+	bool collectChunks ( std::vector<Chunk> &chunks, std::vector<util::vector4<size_t> > &positions, bool copyMetaData );
 
 	/**
 	 * Get the pointer to the chunk in the internal lookup-table at position at.
@@ -337,22 +367,18 @@ public:
 			}
 		}
 
-		if ( ! isEmpty() ) {
-			LOG ( Debug, info ) << "Reindexing image with " << cnt << " chunks.";
-
-			if ( !reIndex() ) {
-				LOG ( Runtime, error ) << "Failed to create image from " << cnt << " chunks.";
-			} else {
-				LOG_IF ( !getMissing().empty(), Debug, warning )
-						<< "The created image is missing some properties: " << getMissing() << ". It will be invalid.";
-			}
-		} else {
-			LOG ( Debug, warning ) << "Image is empty after inserting chunks.";
-		}
-
+		indexInsertedChunks ( cnt );
 		return cnt;
 	}
 
+	/**
+	 * Create image from a vector of Chunks in one step.
+	 * This is the fast way to create an image out of many chunks - especially if they are ordered already.
+	 * The sort keys of the chunks are computed once, and the chunks are inserted in sorted order without any intermediate copies.
+	 * Removes used chunks from the given vector. So afterwards the vector consists of the rejected chunks.
+	 */
+	Image ( std::vector<Chunk> &chunks, dimensions min_dim = rowDim );
+
 
 	/**
 	 * Create image from a single chunk.
@@ -367,6 +393,13 @@ public:
 
 	bool checkMakeClean();
 	bool isClean() const;
+
+	/**
+	 * Get a key to group chunks which might form an image together.
+	 * The key is made of the size of the chunk and the properties which must be equal for all chunks of an image.
+	 * So chunks with different keys will never end up in the same image (but equal keys do not guarantee they will).
+	 */
+	static std::string getChunkGroupKey ( const Chunk &chunk );
 	/**
 	 * This method returns a reference to the voxel value at the given coordinates.
 	 *
@@ -431,6 +464,62 @@ public:
 	const_iterator begin() const;
 	const_iterator end() const;
 
+	/**
+	 * Get the voxels of the image as list of contiguous segments (one per chunk) in the order of the voxels.
+	 * Looping through the segments is much faster than using the iterators of the image, and
+	 * the algorithms in data::segmented can be used on them.
+	 * The segments stay valid as long as the chunks of the image are not changed (e.g. by convertToType).
+	 * If the image is not clean, reIndex will be run.
+	 * \returns the segments, or an empty list if the image is not clean or any of its chunks is not of type T
+	 */
+	template<typename T> std::vector<Segment<T> > getSegments() {
+		std::vector<Segment<T> > ret;
+
+		if ( !checkMakeClean() ) {
+			LOG ( Debug, error )  << "Image is not clean. Returning empty segment list ...";
+			return ret;
+		}
+
+		ret.reserve ( lookup.size() );
+
+		for ( size_t i = 0; i < lookup.size(); i++ ) {
+			if ( !lookup[i]->is<T>() ) {
+				LOG ( Debug, error ) << "Chunk " << i << " is not of type " << util::Value<T>::staticName() << ". Returning empty segment list ...";
+				return std::vector<Segment<T> >();
+			}
+
+			ValueArray<T> &data = lookup[i]->asValueArray<T>();
+			T *const start = &data[0];
+			ret.push_back ( Segment<T> ( start, start + data.getLength() ) );
+		}
+
+		return ret;
+	}
+	/// \copydoc getSegments
+	template<typename T> std::vector<Segment<const T> > getSegments()const {
+		std::vector<Segment<const T> > ret;
+
+		if ( !isClean() ) {
+			LOG ( Debug, error )  << "Image is not clean. Returning empty segment list ...";
+			return ret;
+		}
+
+		ret.reserve ( lookup.size() );
+
+		for ( size_t i = 0; i < lookup.size(); i++ ) {
+			if ( !lookup[i]->is<T>() ) {
+				LOG ( Debug, error ) << "Chunk " << i << " is not of type " << util::Value<T>::staticName() << ". Returning empty segment list ...";
+				return std::vector<Segment<const T> >();
+			}
+
+			const ValueArray<T> &data = lookup[i]->asValueArray<T>();
+			const T *const start = &data[0];
+			ret.push_back ( Segment<const T> ( start, start + data.getLength() ) );
+		}
+
+		return ret;
+	}
+
 	/**
 	 * Get a chunk via index (and the lookup table).
 	 * The returned chunk will be a cheap copy of the original chunk.
@@ -514,6 +603,21 @@ public:
 	 * \returns true if the Chunk was inserted, false otherwise.
 	 */
 	bool insertChunk ( const Chunk &chunk );
+	/**
+	 * Append a volume as new timestep to the Image.
+	 * This is meant for images which grow while they are acquired (e.g. real-time fMRI).
+	 * Other than insertChunk, this does not need a reIndex. The image stays clean and only the new chunk is looked at.
+	 * That only works if the chunks of the image are volumes (one chunk per timestep). Then the chunk must
+	 * - have the same size and geometry as the other chunks of the image
+	 * - have an acquisitionNumber bigger than that of the last timestep
+	 * - not have any property lists.
+	 *
+	 * Properties of the image the chunk does not have are assumed to be valid for the chunk as well.
+	 * If the image is not clean or not made of volumes, the chunk is inserted using insertChunk and the image is reindexed.
+	 * \param chunk the volume to be appended
+	 * \returns true if the chunk was appended and the image is clean, false otherwise
+	 */
+	bool appendTimestep ( const Chunk &chunk );
 	/**
 	 * (Re)computes the image layout and metadata.
 	 * The image will be "clean" on success.
@@ -698,9 +802,10 @@ public:
 	 * If neccessary a conversion into the requested type is done using the given scale.
 	 * \param ID the ID of the requested type (type of the respective source chunk is used if not given)
 	 * \param scaling the scaling to be used when converting the data (will be determined automatically if not given)
+	 * \param policy parallel_execution to copy multiple chunks at once (see data::setExecutionPolicy)
 	 * \return a new deep copied Image of the same size
 	 */
-	Image copyByID( unsigned short ID = 0, scaling_pair scaling = scaling_pair() )const;
+	Image copyByID( unsigned short ID = 0, scaling_pair scaling = scaling_pair(), execution_policy policy = default_execution )const;
 
 
 	/**
@@ -717,9 +822,12 @@ public:
 	 * Ensure, the image has the type with the requested ID.
 	 * If the typeID of any chunk is not equal to the requested ID, the data of the chunk is replaced by an converted version.
 	 * The conversion is done using the value range of the image.
+	 * \param ID the ID of the requested type
+	 * \param scaleopt the scaling strategy
+	 * \param policy parallel_execution to convert multiple chunks at once (see data::setExecutionPolicy)
 	 * \returns false if there was an error
 	 */
-	bool convertToType ( short unsigned int ID, isis::data::autoscaleOption scaleopt = autoscale );
+	bool convertToType ( short unsigned int ID, isis::data::autoscaleOption scaleopt = autoscale, execution_policy policy = default_execution );
 
 	/**
 	 * Automatically splice the given dimension and all dimensions above.
@@ -735,6 +843,18 @@ public:
 	 */
 	size_t foreachChunk ( ChunkOp &op, bool copyMetaData = false );
 
+	/**
+	 * Run a functor with the base ParallelChunkOp on every chunk in the image using multiple threads.
+	 * The order in which the chunks are processed is undefined.
+	 * If the resolved policy is not parallel_execution, op itself is run on all chunks in the calling thread.
+	 * If op (or its clone()) throws, the first exception is rethrown once all threads stopped.
+	 * \param op a functor object which inherits ParallelChunkOp
+	 * \param copyMetaData if true the metadata of the image are copied into the chunks before calling the functor
+	 * \param policy parallel_execution to process multiple chunks at once (see data::setExecutionPolicy)
+	 * \returns amount of operations which returned false - so 0 is good!
+	 */
+	size_t foreachChunk ( ParallelChunkOp &op, bool copyMetaData = false, execution_policy policy = default_execution );
+
 
 	/**
 	 * Run a functor with the base VoxelOp on every chunk in the image.
@@ -757,6 +877,91 @@ public:
 		return convertToType ( data::ValueArray<TYPE>::staticID ) && foreachChunk ( prx, false );
 	}
 
+	/**
+	 * Run any callable on every voxel in the image.
+	 * Other than with VoxelOp, op is not called virtually, so simple operations can be inlined by the compiler.
+	 * If any chunk does not have the requested type it will be converted.
+	 * If these conversion failes no operation is done, and 0 is returned.
+	 * \param op a callable which can be called as bool op( TYPE &vox, const util::vector4\<size_t\> &pos )
+	 * \returns amount of operations which returned false - so 0 is good!
+	 */
+	template <typename TYPE, typename OP> typename boost::disable_if<boost::is_base_of<VoxelOp<TYPE>, OP>, size_t>::type
+	foreachVoxel ( OP &op ) {
+		std::vector<Chunk> chunks;
+		std::vector<util::vector4<size_t> > positions;
+
+		if( !convertToType ( data::ValueArray<TYPE>::staticID ) || !collectChunks ( chunks, positions, false ) )
+			return 0;
+
+		size_t ret = 0;
+
+		for( size_t i = 0; i < chunks.size(); i++ )
+			ret += chunks[i].foreachVoxel<TYPE> ( op, positions[i] );
+
+		return ret;
+	}
+
+	/**
+	 * Run any callable on the value of every voxel in the image.
+	 * The voxel positions are not computed, so for simple operations the compiler can inline and vectorise the loop.
+	 * If any chunk does not have the requested type it will be converted.
+	 * If these conversion failes no operation is done.
+	 * \param op a callable which can be called as op( TYPE &vox ) - its return value is ignored
+	 * \returns a copy of op after it was called for all voxels (like std::for_each)
+	 */
+	template <typename TYPE, typename OP> OP foreachValue ( OP op ) {
+		std::vector<Chunk> chunks;
+		std::vector<util::vector4<size_t> > positions;
+
+		if( convertToType ( data::ValueArray<TYPE>::staticID ) && collectChunks ( chunks, positions, false ) ) {
+			for( size_t i = 0; i < chunks.size(); i++ ) {
+				TYPE *const start = &chunks[i].asValueArray<TYPE>()[0];
+				TYPE *const end = start + chunks[i].getVolume();
+
+				for( TYPE *vox = start; vox != end; ++vox )
+					op( *vox );
+			}
+		}
+
+		return op;
+	}
+
+	/**
+	 * Run a functor with the base ParallelVoxelOp on every voxel in the image using multiple threads.
+	 * The voxels of all chunks are split into blocks, which are processed by clones of op.
+	 * So the order in which the voxels are visited is undefined.
+	 * If any chunk does not have the requested type it will be converted.
+	 * If these conversion failes no operation is done, and 0 is returned.
+	 * If the resolved policy is not parallel_execution, op itself is run on all voxels in the calling thread.
+	 * If op (or its clone()) throws, the first exception is rethrown once all threads stopped.
+	 * \param op a functor object which inherits ParallelVoxelOp
+	 * \param policy parallel_execution to process multiple blocks of voxels at once (see data::setExecutionPolicy)
+	 * \returns amount of operations which returned false - so 0 is good!
+	 */
+	template <typename TYPE> size_t foreachVoxel ( ParallelVoxelOp<TYPE> &op, execution_policy policy = default_execution ) {
+		std::vector<Chunk> chunks;
+		std::vector<util::vector4<size_t> > positions;
+
+		if( !convertToType ( data::ValueArray<TYPE>::staticID ) || !collectChunks ( chunks, positions, false ) )
+			return 0;
+
+		if( resolveExecutionPolicy( policy ) != parallel_execution ) {
+			size_t ret = 0;
+
+			for( size_t i = 0; i < chunks.size(); i++ )
+				ret += chunks[i].foreachVoxel<TYPE> ( static_cast<VoxelOp<TYPE>&>( op ), positions[i] );
+
+			return ret;
+		}
+
+		_internal::VoxelBlockJob<TYPE> job;
+
+		for( size_t i = 0; i < chunks.size(); i++ )
+			job.add ( chunks[i].asValueArray<TYPE>(), chunks[i].getSizeAsVector(), positions[i] );
+
+		return _internal::runParallelOp ( op, job, job.blocks() );
+	}
+
 	/// \returns the number of rows of the image
 	size_t getNrOfRows() const;
 	/// \returns the number of columns of the image
@@ -885,7 +1090,7 @@ public:
 		conv_op.scale = ref.getScalingTo ( ValueArray<T>::staticID );
 		LOG ( Debug, info ) << "Computed scaling for conversion from source image: [" << conv_op.scale << "]";
 
-		this->set.transform ( conv_op );
+		this->set.transform ( conv_op, getExecutionPolicy() );
 
 		if ( ref.isClean() ) {
 			this->lookup = this->set.getLookup(); // the lookup table still points to the old chunks
@@ -898,6 +1103,120 @@ public:
 	}
 };
 
+/**
+ * Typed view of the voxels of an Image for fast random access.
+ * The pointers to the voxel data and the strides are computed once when the view is created.
+ * So other than Image::voxel, accessing a voxel is just some pointer arithmetic (no lookup, no division and no type check).
+ * This makes it suitable for neighbourhood-heavy code like interpolation or convolution.
+ *
+ * The view references the voxel data of the image (and keeps them alive). So changes done through it are visible in the image and vice versa.
+ * But changes of the chunks of the image (e.g. by convertToType) are not reflected by an existing view.
+ * Use ImageView\<const T\> for read-only access (this is the only variant available for const images).
+ * The position given to voxel() is only checked if debug logging is enabled.
+ */
+template<typename T> class ImageView
+{
+	typedef typename boost::remove_const<T>::type value_type_nc;
+	typedef typename boost::mpl::if_<boost::is_const<T>, const Image, Image>::type image_type;
+	typedef typename boost::mpl::if_<boost::is_const<T>, const ValueArray<value_type_nc>, ValueArray<value_type_nc> >::type array_type;
+
+	std::vector<ValueArray<value_type_nc> > m_data;
+	/*
+	 * The chunks of an image cover the lower dimensions completely (e.g. a slice covers all rows and columns)
+	 * and the "split" dimension partially (e.g. the slice dimension).
+	 * So the image can be seen as a list of "slabs" - one for every position in the split and the higher dimensions.
+	 * m_slabs has the start of every slab, m_outer the stride to find the slab and m_inner the stride inside the slab.
+	 */
+	std::vector<T *> m_slabs;
+	size_t m_inner[4], m_outer[4];
+	util::vector4<size_t> m_size;
+
+	static bool makeClean ( Image &img ) {return img.checkMakeClean();}
+	static bool makeClean ( const Image &img ) {return img.isClean();}
+public:
+	typedef T value_type;
+	typedef T &reference;
+
+	/// Creates an invalid view.
+	ImageView() {
+		std::fill ( m_inner, m_inner + 4, 0 );
+		std::fill ( m_outer, m_outer + 4, 0 );
+	}
+	/**
+	 * Create a view on the given image.
+	 * If the image is not clean, reIndex will be run (if its not const).
+	 * If the image is not clean afterwards, or any of its chunks is not of type T, the view will be invalid.
+	 */
+	explicit ImageView ( image_type &img ) {
+		std::fill ( m_inner, m_inner + 4, 0 );
+		std::fill ( m_outer, m_outer + 4, 0 );
+
+		if ( !makeClean ( img ) ) {
+			LOG ( Debug, error ) << "Image is not clean. Creating invalid view ...";
+			return;
+		}
+
+		const std::vector<Chunk> chunks = img.copyChunksToVector ( false );
+
+		if ( chunks.empty() ) {
+			LOG ( Debug, error ) << "Image is empty. Creating invalid view ...";
+			return;
+		}
+
+		const util::vector4<size_t> chunkSize = chunks.front().getSizeAsVector();
+		m_size = img.getSizeAsVector();
+
+		size_t split = 0, slab_len = 1, slab_count = 1;
+
+		while ( split < 4 && chunkSize[split] == m_size[split] ) {
+			m_inner[split] = slab_len;
+			slab_len *= m_size[split++];
+		}
+
+		for ( size_t d = split; d < 4; d++ ) {
+			m_outer[d] = slab_count;
+			slab_count *= m_size[d];
+		}
+
+		m_data.reserve ( chunks.size() );
+		m_slabs.reserve ( slab_count );
+
+		for ( size_t i = 0; i < chunks.size(); i++ ) {
+			if ( !chunks[i].is<value_type_nc>() ) {
+				LOG ( Debug, error ) << "Chunk " << i << " is not of type " << util::Value<value_type_nc>::staticName() << ". Creating invalid view ...";
+				m_slabs.clear();
+				m_data.clear();
+				return;
+			}
+
+			m_data.push_back ( chunks[i].getValueArray<value_type_nc>() );
+			array_type &data = m_data.back();
+			T *const start = &data[0];
+
+			for ( size_t offset = 0; offset < data.getLength(); offset += slab_len )
+				m_slabs.push_back ( start + offset );
+		}
+
+		assert ( m_slabs.size() == slab_count );
+	}
+
+	/// \returns false if the view was created from an unclean image or from an image of another type
+	bool isValid() const {return !m_slabs.empty();}
+	/// \returns the size of the viewed image
+	util::vector4<size_t> getSizeAsVector() const {return m_size;}
+
+	/**
+	 * Get a reference to the voxel at the given coordinates.
+	 * If the coordinates are out of range, behaviour is undefined (if debug logging is enabled, an error will be sent).
+	 */
+	T &voxel ( size_t first, size_t second = 0, size_t third = 0, size_t fourth = 0 ) const {
+		LOG_IF ( first >= m_size[0] || second >= m_size[1] || third >= m_size[2] || fourth >= m_size[3], Debug, isis::error )
+				<< "Index " << util::vector4<size_t> ( first, second, third, fourth ) << " is out of range (" << m_size << ")";
+		return m_slabs[first * m_outer[0] + second * m_outer[1] + third * m_outer[2] + fourth * m_outer[3]]
+			   [first * m_inner[0] + second * m_inner[1] + third * m_inner[2] + fourth * m_inner[3]];
+	}
+};
+
 }
 }
 
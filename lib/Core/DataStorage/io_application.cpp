@@ -86,6 +86,12 @@ void IOApplication::addInput ( util::ParameterMap &parameters, bool needed, cons
 		parameters["np"].setDescription( "suppress progress bar" );
 		parameters["np"].hidden() = true;
 	}
+
+	if( parameters.find( "threads" ) == parameters.end() ) {
+		parameters["threads"] = ( uint16_t )1;
+		parameters["threads"].needed() = false;
+		parameters["threads"].setDescription( "amount of files to be read concurrently when loading a directory (0 means one per cpu core), anything but 1 also enables parallel conversion of images" );
+	}
 }
 
 void IOApplication::addOutput ( util::ParameterMap &parameters, bool needed, const std::string &suffix, const std::string &desc )
@@ -180,6 +186,12 @@ bool IOApplication::autoload ( const util::ParameterMap &parameters, std::list<I
 		data::IOFactory::setProgressFeedback( feedback );
 	}
 
+	if( parameters.find( "threads" ) != parameters.end() ) {
+		const uint16_t threads = parameters["threads"];
+		data::IOFactory::setThreads( threads );
+		setExecutionPolicy( threads == 1 ? sequential_execution : parallel_execution );
+	}
+
 	const std::list< Image > tImages = data::IOFactory::load( input, rf.c_str(), dl.c_str() );
 
 	images.insert( images.end(), tImages.begin(), tImages.end() );
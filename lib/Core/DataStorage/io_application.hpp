@@ -45,6 +45,7 @@ public:
 	 * - \c -in the filename or path to load from
 	 * - \c -rf to override the file suffix used to select the plugin used for reading
 	 * - \c -rdialect selects a special dialect used for reading
+	 * - \c -threads sets the amount of files to be read concurrently (see IOFactory::setThreads)
 	 * \param parameters the ParameterMap the parameters should be added to
 	 * \param needed if true, the -in parameter is marked as needed (init will fail, if this is not set)
 	 * \param suffix text to be appended to the parameters above (eg. "1" here results in "-in1" etc.) to distinguish multiple inputs
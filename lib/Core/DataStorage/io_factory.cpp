@@ -29,7 +29,11 @@
 #include <boost/foreach.hpp>
 #include <boost/system/error_code.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/bind.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/thread/locks.hpp>
 #include "../CoreUtils/singletons.hpp"
+#include "../CoreUtils/threadpool.hpp"
 
 namespace isis
 {
@@ -68,6 +72,12 @@ struct dialect_missing {
 	}
 };
 
+// a chunk which knows its position in the list given to chunkListToImageList
+struct IndexedChunk: Chunk {
+	size_t index;
+	IndexedChunk( const Chunk &ch, size_t idx ): Chunk( ch ), index( idx ) {}
+};
+
 bool invalid_and_tell( Chunk &candidate )
 {
 	LOG_IF( !candidate.isValid(), image_io::Runtime, error ) << "Ignoring invalid chunk. Missing properties: " << candidate.getMissing();
@@ -78,7 +88,7 @@ bool invalid_and_tell( Chunk &candidate )
 /// @endcond _internal
 API_EXCLUDE_BEGIN;
 
-IOFactory::IOFactory()
+IOFactory::IOFactory(): m_threads( 1 )
 {
 	const char *env_path = getenv( "ISIS_PLUGIN_PATH" );
 	const char *env_home = getenv( "HOME" );
@@ -126,12 +136,13 @@ bool IOFactory::registerFileFormat( const FileFormatPtr plugin )
 {
 	if ( !plugin )return false;
 
-	io_formats.push_back( plugin );
 	std::list<util::istring> suffixes = plugin->getSuffixes(  );
 	LOG( Runtime, info )
 			<< "Registering " << ( plugin->tainted() ? "tainted " : "" ) << "io-plugin "
 			<< util::MSubject( plugin->getName() )
 			<< " with supported suffixes " << suffixes;
+	const boost::lock_guard<boost::mutex> lock( m_lock );
+	io_formats.push_back( plugin );
 	BOOST_FOREACH( util::istring & it, suffixes ) {
 		io_suffix[it].push_back( plugin );
 	}
@@ -214,7 +225,7 @@ IOFactory &IOFactory::get()
 	return util::Singletons::get<IOFactory, INT_MAX>();
 }
 
-size_t IOFactory::loadFile( std::list<Chunk> &ret, const boost::filesystem::path &filename, util::istring suffix_override, util::istring dialect )
+size_t IOFactory::loadFile( std::list<Chunk> &ret, const boost::filesystem::path &filename, util::istring suffix_override, util::istring dialect, boost::shared_ptr<util::ProgressFeedback> feedback )
 {
 	FileFormatList formatReader;
 	formatReader = getFileFormatList( filename.string(), suffix_override, dialect );
@@ -237,7 +248,7 @@ size_t IOFactory::loadFile( std::list<Chunk> &ret, const boost::filesystem::path
 					<< "plugin to load file" << with_dialect << " " << util::MSubject( filename ) << ": " << it->getName();
 
 			try {
-				int loaded=it->load( ret, filename.native(), dialect, m_feedback );
+				int loaded=it->load( ret, filename.native(), dialect, feedback );
 				BOOST_FOREACH( Chunk & ref, ret ) {
 					if ( ! ref.hasProperty( "source" ) )
 						ref.setPropertyAs( "source", filename.native() );
@@ -274,11 +285,14 @@ IOFactory::FileFormatList IOFactory::getFileFormatList( std::string filename, ut
 		if( !ext.empty() )ext.pop_front(); // remove the first "suffix" - actually the basename
 	} else ext = util::stringToList<std::string>( suffix_override, '.' );
 
+	const IOFactory &This = get();
+
 	while( !ext.empty() ) {
 		const util::istring wholeName( util::listToString( ext.begin(), ext.end(), ".", "", "" ).c_str() ); // (re)construct the rest of the suffix
-		const std::map<util::istring, FileFormatList>::iterator found = get().io_suffix.find( wholeName );
+		const boost::lock_guard<boost::mutex> lock( This.m_lock );
+		const std::map<util::istring, FileFormatList>::const_iterator found = This.io_suffix.find( wholeName );
 
-		if( found != get().io_suffix.end() ) {
+		if( found != This.io_suffix.end() ) {
 			LOG( Debug, verbose_info ) << found->second.size() << " plugins support suffix " << wholeName;
 			ret.insert( ret.end(), found->second.begin(), found->second.end() );
 		}
@@ -305,13 +319,44 @@ std::list< Image > IOFactory::chunkListToImageList( std::list<Chunk> &src )
 	src.remove_if( _internal::invalid_and_tell );
 	errcnt -= src.size();
 
+	// group the chunks by size and by the properties which must be equal within an image
+	// chunks of different groups can never be part of the same image, so the images can be made from the groups separately
+	std::vector<std::list<_internal::IndexedChunk> > groups;
+	{
+		boost::unordered_map<std::string, size_t> group_idx;
+		size_t index = 0;
+
+		for( std::list<Chunk>::iterator i = src.begin(); i != src.end(); ++i ) {
+			const std::pair<boost::unordered_map<std::string, size_t>::iterator, bool> found =
+				group_idx.insert( std::make_pair( Image::getChunkGroupKey( *i ), groups.size() ) );
+
+			if( found.second )
+				groups.push_back( std::list<_internal::IndexedChunk>() );
+
+			groups[found.first->second].push_back( _internal::IndexedChunk( *i, index++ ) );
+		}
+
+		src.clear();
+		LOG( Debug, info ) << "Sorted " << index << " chunks into " << groups.size() << " groups";
+	}
+
 	std::list< Image > ret;
 
-	while ( !src.empty() ) {
-		LOG( Debug, info ) << src.size() << " Chunks left to be distributed.";
-		size_t before = src.size();
+	while ( true ) {
+		// use the group with the earliest remaining chunk, so the images are created in the same order as from the whole list
+		std::vector<std::list<_internal::IndexedChunk> >::iterator group = groups.end();
 
-		Image buff( src );
+		for( std::vector<std::list<_internal::IndexedChunk> >::iterator i = groups.begin(); i != groups.end(); ++i )
+			if( !i->empty() && ( group == groups.end() || i->front().index < group->front().index ) )
+				group = i;
+
+		if( group == groups.end() )
+			break;
+
+		LOG( Debug, info ) << group->size() << " Chunks left to be distributed in the current group.";
+		size_t before = group->size();
+
+		Image buff( *group );
 
 		if ( buff.isClean() ) {
 			if( buff.isValid() ) { //if the image was successfully indexed and is valid, keep it
@@ -320,7 +365,7 @@ std::list< Image > IOFactory::chunkListToImageList( std::list<Chunk> &src )
 			} else {
 				LOG_IF( !buff.getMissing().empty(), Runtime, error )
 						<< "Cannot insert image. Missing properties: " << buff.getMissing();
-				errcnt += before - src.size();
+				errcnt += before - group->size();
 			}
 		} else
 			LOG( Runtime, info ) << "Dropping non clean Image";
@@ -335,7 +380,7 @@ size_t IOFactory::load( std::list<data::Chunk> &chunks, const std::string &path,
 	const boost::filesystem::path p( path );
 	const size_t loaded = boost::filesystem::is_directory( p ) ?
 						  get().loadPath( chunks, p, suffix_override, dialect ) :
-						  get().loadFile( chunks, p, suffix_override, dialect );
+						  get().loadFile( chunks, p, suffix_override, dialect, get().getFeedback() );
 	return loaded;
 }
 
@@ -359,28 +404,81 @@ std::list<data::Image> IOFactory::load( const std::string &path, util::istring s
 
 size_t IOFactory::loadPath( std::list<Chunk> &ret, const boost::filesystem::path &path, util::istring suffix_override, util::istring dialect )
 {
-	int loaded = 0;
-
-	if( m_feedback ) {
-		const size_t length = std::distance( boost::filesystem::directory_iterator( path ), boost::filesystem::directory_iterator() ); //@todo this will also count directories
-		m_feedback->show( length, std::string( "Reading " ) + util::Value<std::string>( length ).toString( false ) + " files from " + path.native() );
-	}
+	size_t loaded = 0;
+	std::vector<boost::filesystem::path> files;
 
 	for ( boost::filesystem::directory_iterator i( path ); i != boost::filesystem::directory_iterator(); ++i )  {
 		if ( boost::filesystem::is_directory( *i ) )continue;
 
-		loaded += loadFile( ret, *i, suffix_override, dialect );
+		files.push_back( *i );
+	}
+
+	const boost::shared_ptr<util::ProgressFeedback> feedback = getFeedback();
+
+	if( feedback ) {
+		feedback->show( files.size(), std::string( "Reading " ) + util::Value<std::string>( files.size() ).toString( false ) + " files from " + path.native() );
+	}
+
+	if( m_threads != 1 && files.size() > 1 ) {
+		loaded = loadPathConcurrent( ret, files, suffix_override, dialect, feedback );
+	} else {
+		BOOST_FOREACH( const boost::filesystem::path & file, files ) {
+			loaded += loadFile( ret, file, suffix_override, dialect, feedback );
 
-		if( m_feedback )
-			m_feedback->progress();
+			if( feedback )
+				feedback->progress();
+		}
 	}
 
-	if( m_feedback )
-		m_feedback->close();
+	if( feedback )
+		feedback->close();
 
 	return loaded;
 }
 
+size_t IOFactory::loadPathConcurrent( std::list<Chunk> &ret, const std::vector<boost::filesystem::path> &files, util::istring suffix_override, util::istring dialect, boost::shared_ptr<util::ProgressFeedback> feedback )
+{
+	// every file gets its own chunk list, so the workers only have to share the progress display
+	std::vector<std::list<Chunk> > chunks( files.size() );
+	std::vector<size_t> loaded( files.size(), 0 );
+	{
+		// the workers advance the progress through a ParallelFeedback, so they don't wait for the display
+		const boost::shared_ptr<util::ProgressFeedback> parallel( feedback ? new util::ParallelFeedback( feedback ) : NULL );
+		const size_t threads = m_threads;
+		util::ThreadPool pool( std::min( threads ? threads : util::ThreadPool::hardwareThreads(), files.size() ) );
+		LOG( Debug, info ) << "Loading " << files.size() << " files using " << pool.threads() << " threads";
+
+		for( size_t i = 0; i < files.size(); i++ ) {
+			pool.post( boost::bind(
+						   &IOFactory::loadFileTask, this,
+						   boost::ref( chunks[i] ), boost::ref( loaded[i] ), boost::cref( files[i] ),
+						   suffix_override, dialect, parallel
+					   ) );
+		}
+
+		pool.wait();
+	}
+
+	// merge the results in directory order, so they don't depend on which worker was done first
+	size_t ret_cnt = 0;
+
+	for( size_t i = 0; i < files.size(); i++ ) {
+		ret.splice( ret.end(), chunks[i] );
+		ret_cnt += loaded[i];
+	}
+
+	return ret_cnt;
+}
+
+void IOFactory::loadFileTask( std::list<Chunk> &ret, size_t &loaded, const boost::filesystem::path &filename, util::istring suffix_override, util::istring dialect, boost::shared_ptr<util::ProgressFeedback> feedback )
+{
+	// the plugins don't get the progress display, they would use it concurrently
+	loaded = loadFile( ret, filename, suffix_override, dialect, boost::shared_ptr<util::ProgressFeedback>() );
+
+	if( feedback )
+		feedback->progress();
+}
+
 bool IOFactory::write( const data::Image &image, const std::string &path, util::istring suffix_override, util::istring dialect )
 {
 	return write( std::list<data::Image>( 1, image ), path, suffix_override, dialect );
@@ -405,7 +503,7 @@ bool IOFactory::write( std::list< isis::data::Image > images, const std::string
 						);
 
 			try {
-				it->write( images, path, dialect, get().m_feedback );
+				it->write( images, path, dialect, get().getFeedback() );
 				LOG( Runtime, info )
 						<< images.size()
 						<< " images written to " << path << " using " <<  it->getName()
@@ -429,15 +527,36 @@ bool IOFactory::write( std::list< isis::data::Image > images, const std::string
 void IOFactory::setProgressFeedback( boost::shared_ptr<util::ProgressFeedback> feedback )
 {
 	IOFactory &This = get();
+	boost::shared_ptr<util::ProgressFeedback> old = feedback;
+	{
+		const boost::lock_guard<boost::mutex> lock( This.m_lock );
+		This.m_feedback.swap( old );
+	}
+
+	if( old )old->close();
+}
 
-	if( This.m_feedback )This.m_feedback->close();
+boost::shared_ptr<util::ProgressFeedback> IOFactory::getFeedback()const
+{
+	const boost::lock_guard<boost::mutex> lock( m_lock );
+	return m_feedback;
+}
+
+void IOFactory::setThreads( size_t threads )
+{
+	get().m_threads = threads;
+}
 
-	This.m_feedback = feedback;
+size_t IOFactory::getThreads()
+{
+	return get().m_threads;
 }
 
 IOFactory::FileFormatList IOFactory::getFormats()
 {
-	return get().io_formats;
+	const IOFactory &This = get();
+	const boost::lock_guard<boost::mutex> lock( This.m_lock );
+	return This.io_formats;
 }
 
 
@@ -17,10 +17,13 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 #include <boost/regex.hpp>
 #define BOOST_FILESYSTEM_VERSION 3 
 #include <boost/filesystem.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/atomic.hpp>
 
 #include "io_interface.h"
 #include "../CoreUtils/progressfeedback.hpp"
@@ -34,6 +37,11 @@ namespace isis
 namespace data
 {
 
+/**
+ * Registry of the io-plugins and entry point for loading and writing images.
+ * The plugins are registered once when the factory is created on first use.
+ * All static functions can be used from multiple threads at the same time, and from within plugins (e.g. to load the content of an archive).
+ */
 class IOFactory
 {
 public:
@@ -43,6 +51,10 @@ public:
 
 private:
 	boost::shared_ptr<util::ProgressFeedback> m_feedback;
+	boost::atomic<size_t> m_threads;
+	// protects the registry (io_formats, io_suffix) and m_feedback
+	// its only held while they are accessed, not while loading, so plugins can use the IOFactory recursively
+	mutable boost::mutex m_lock;
 	// use ImageIO's logging here instead of the normal data::Runtime/Debug
 	typedef ImageIoLog Runtime;
 	typedef ImageIoDebug Debug;
@@ -82,6 +94,17 @@ public:
 
 	static void setProgressFeedback( boost::shared_ptr<util::ProgressFeedback> feedback );
 
+	/**
+	 * Set the amount of files which are loaded concurrently when loading a directory.
+	 * The files are parsed by a pool of worker threads, the resulting chunks are merged in directory order afterwards.
+	 * So the outcome does not depend on which worker was done first.
+	 * \note the used io-plugins must be able to load multiple files at the same time
+	 * \param threads amount of worker threads (0 means one per cpu core, 1 disables concurrent loading)
+	 */
+	static void setThreads( size_t threads );
+	/// \returns the amount of files which are loaded concurrently when loading a directory
+	static size_t getThreads();
+
 	/**
 	 * Get all formats which should be able to read/write the given file.
 	 * \param filename the file which should be red/written
@@ -98,8 +121,11 @@ public:
 	 */
 	static std::list<data::Image> chunkListToImageList( std::list<Chunk> &chunks );
 protected:
-	size_t loadFile( std::list<Chunk> &ret, const boost::filesystem::path &filename, util::istring suffix_override = "", util::istring dialect = "" );
+	size_t loadFile( std::list<Chunk> &ret, const boost::filesystem::path &filename, util::istring suffix_override, util::istring dialect, boost::shared_ptr<util::ProgressFeedback> feedback );
 	size_t loadPath( std::list<Chunk> &ret, const boost::filesystem::path &path, util::istring suffix_override = "", util::istring dialect = "" );
+	size_t loadPathConcurrent( std::list<Chunk> &ret, const std::vector<boost::filesystem::path> &files, util::istring suffix_override, util::istring dialect, boost::shared_ptr<util::ProgressFeedback> feedback );
+	void loadFileTask( std::list<Chunk> &ret, size_t &loaded, const boost::filesystem::path &filename, util::istring suffix_override, util::istring dialect, boost::shared_ptr<util::ProgressFeedback> feedback );
+	boost::shared_ptr<util::ProgressFeedback> getFeedback()const;
 
 	static IOFactory &get();
 	IOFactory();//shall not be created directly
@@ -18,6 +18,8 @@
 */
 
 #include "numeric_convert.hpp"
+#include "../CoreUtils/threadpool.hpp"
+#include <boost/atomic.hpp>
 
 #ifdef ISIS_USE_LIBOIL
 extern "C" {
@@ -170,5 +172,226 @@ IMPL_SCALED_CONVERT( uint8_t, double, u8, f64 )
 API_EXCLUDE_END;
 }
 }
+#else //ISIS_USE_LIBOIL
+
+// the kernels for the extended instruction sets are built using gcc's target attribute and selected using cpuid
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define ISIS_NUMERIC_DISPATCH 1
+#define ISIS_TARGET_AVX2 __attribute__(( target( "avx2" ) ))
+#define ISIS_TARGET_AVX512 __attribute__(( target( "avx512f,avx512bw,avx512dq,avx512vl" ) ))
+#endif
+#define ISIS_TARGET_GENERIC
+
+namespace isis
+{
+namespace data
+{
+API_EXCLUDE_BEGIN;
+namespace _internal
+{
+namespace
+{
+
+numeric_isa detectNumericIsa()
+{
+#ifdef ISIS_NUMERIC_DISPATCH
+	__builtin_cpu_init();
+
+	if( __builtin_cpu_supports( "avx512f" ) && __builtin_cpu_supports( "avx512bw" ) &&
+		__builtin_cpu_supports( "avx512dq" ) && __builtin_cpu_supports( "avx512vl" ) )
+		return avx512_isa;
+
+	if( __builtin_cpu_supports( "avx2" ) )
+		return avx2_isa;
+
+#endif
+	return generic_isa;
+}
+
+const numeric_isa supported_isa = detectNumericIsa();
+// setNumericIsa may be called while conversions run on the pool, relaxed is enough as no other data depends on it
+boost::atomic<numeric_isa> current_isa( supported_isa );
+
+/*
+ * Single element conversion equivalent to round<DST>().
+ * It selects the offset instead of branching, so the loops below can be vectorized.
+ * Unscaled conversions between integers don't need the detour via double.
+ */
+template<typename SRC, typename DST, bool INTEGERS> struct element_convert;
+template<typename SRC, typename DST> struct element_convert<SRC, DST, false> {
+	static inline DST apply( double x ) {
+		return std::numeric_limits<DST>::is_integer ? static_cast<DST>( x + ( x < 0 ? -0.5 : 0.5 ) ) : static_cast<DST>( x );
+	}
+};
+template<typename SRC, typename DST> struct element_convert<SRC, DST, true> {
+	static inline DST apply( SRC x ) {
+		return static_cast<DST>( x );
+	}
+};
+template<typename SRC, typename DST> struct Element:
+	element_convert<SRC, DST, std::numeric_limits<SRC>::is_integer &&std::numeric_limits<DST>::is_integer > {};
+
+// the same loops are compiled for every instruction set
+#define DEF_KERNELS(ISA,TARGET)                                                                                         \
+	template<typename SRC, typename DST> TARGET void convert_ ## ISA( const SRC *src, DST *dst, size_t count ){            \
+		for ( size_t i = 0; i < count; i++ )                                                                            \
+			dst[i] = Element<SRC, DST>::apply( src[i] );                                                                 \
+	}                                                                                                                   \
+	template<typename SRC, typename DST> TARGET void convert_ ## ISA( const SRC *src, DST *dst, size_t count, double scale, double offset ){ \
+		for ( size_t i = 0; i < count; i++ )                                                                            \
+			dst[i] = element_convert<SRC, DST, false>::apply( src[i] * scale + offset ); /* scaled values need rounding */ \
+	}
+
+DEF_KERNELS( generic, ISIS_TARGET_GENERIC )
+#ifdef ISIS_NUMERIC_DISPATCH
+DEF_KERNELS( avx2, ISIS_TARGET_AVX2 )
+DEF_KERNELS( avx512, ISIS_TARGET_AVX512 )
+#endif
+#undef DEF_KERNELS
+
+template<typename SRC, typename DST> void dispatch_convert( const SRC *src, DST *dst, size_t count )
+{
+	const numeric_isa isa = current_isa.load( boost::memory_order_relaxed );
+	LOG( Runtime, info )
+			<< "using " << numericIsaName( isa ) << " convert " << ValueArray<SRC>::staticName() << " => "
+			<< ValueArray<DST>::staticName() << " without scaling";
+
+	switch( isa ) {
+#ifdef ISIS_NUMERIC_DISPATCH
+	case avx512_isa:
+		convert_avx512( src, dst, count );
+		break;
+	case avx2_isa:
+		convert_avx2( src, dst, count );
+		break;
+#endif
+	default:
+		convert_generic( src, dst, count );
+	}
+}
+template<typename SRC, typename DST> void dispatch_convert( const SRC *src, DST *dst, size_t count, double scale, double offset )
+{
+	const numeric_isa isa = current_isa.load( boost::memory_order_relaxed );
+	LOG( Runtime, info )
+			<< "using " << numericIsaName( isa ) << " scaling convert " << ValueArray<SRC>::staticName() << "=>"
+			<< ValueArray<DST>::staticName() << " with scale/offset " << std::fixed << scale << "/" << offset;
+
+	switch( isa ) {
+#ifdef ISIS_NUMERIC_DISPATCH
+	case avx512_isa:
+		convert_avx512( src, dst, count, scale, offset );
+		break;
+	case avx2_isa:
+		convert_avx2( src, dst, count, scale, offset );
+		break;
+#endif
+	default:
+		convert_generic( src, dst, count, scale, offset );
+	}
+}
+
+}
+
+numeric_isa getNumericIsa()
+{
+	return current_isa.load( boost::memory_order_relaxed );
+}
+
+bool setNumericIsa( numeric_isa isa )
+{
+	if( isa > supported_isa ) {
+		LOG( Debug, warning ) << "The cpu does not support the " << numericIsaName( isa ) << " instruction set, won't use it";
+		return false;
+	}
+
+	current_isa.store( isa, boost::memory_order_relaxed );
+	return true;
+}
+
+const char *numericIsaName( numeric_isa isa )
+{
+	switch( isa ) {
+	case avx512_isa:
+		return "avx512";
+	case avx2_isa:
+		return "avx2";
+	case generic_isa:
+		break;
+	}
+
+	return "generic";
+}
+
+#define IMPL_CONVERT(SRC,DST)                                                                                                 \
+	template<> void numeric_convert_impl<SRC,DST>( const SRC *src, DST *dst, size_t count ){                                  \
+		dispatch_convert( src, dst, count );                                                                                  \
+	}                                                                                                                         \
+	template<> void numeric_convert_impl<SRC,DST>( const SRC *src, DST *dst, size_t count, double scale, double offset ){    \
+		dispatch_convert( src, dst, count, scale, offset );                                                                   \
+	}
+
+ISIS_NUMERIC_PAIRS( IMPL_CONVERT )
+
+#undef IMPL_CONVERT
+}
+API_EXCLUDE_END;
+}
+}
 #endif //ISIS_USE_LIBOIL
 
+namespace isis
+{
+namespace data
+{
+API_EXCLUDE_BEGIN;
+namespace _internal
+{
+namespace
+{
+const size_t page_size = 4096;
+boost::atomic<size_t> parallel_convert_threshold( 16 * 1024 * 1024 ); // smaller arrays are not worth the overhead
+}
+
+ConvertBlocks planConvertBlocks( const void *dst, size_t length, size_t elem_size )
+{
+	ConvertBlocks ret = {0, 0, 0, length};
+	const size_t bytes = length * elem_size;
+
+	if( bytes < parallel_convert_threshold || bytes < 2 * page_size || getExecutionPolicy() != parallel_execution )
+		return ret;
+
+	// a few blocks per thread, so they can balance out, but at least one page per block
+	const size_t threads = util::ThreadPool::shared().threads() + 1;
+	size_t block_bytes = bytes / ( threads * 4 );
+	block_bytes = std::max( page_size, block_bytes - block_bytes % page_size );
+
+	// the first block ends at the first page boundary of dst
+	const size_t misalign = reinterpret_cast<size_t>( dst ) % page_size;
+	const size_t head_bytes = misalign ? page_size - misalign : 0;
+
+	if( block_bytes % elem_size || head_bytes % elem_size ) { // elements must not be split by the block borders
+		LOG( Debug, info ) << "Cannot split up the conversion into page aligned blocks, doing it serially";
+		return ret;
+	}
+
+	ret.head = head_bytes / elem_size;
+	ret.block = block_bytes / elem_size;
+	ret.count = 1 + ( length - ret.head + ret.block - 1 ) / ret.block;
+	return ret;
+}
+
+void runConvertBlocks( const ConvertBlocks &blocks, const boost::function<void( size_t )> &job )
+{
+	LOG( Debug, info ) << "Converting " << blocks.length << " elements in " << blocks.count << " blocks of " << blocks.block << " elements";
+	util::ThreadPool::shared().parallelFor( blocks.count, job );
+}
+
+size_t setParallelConvertThreshold( size_t bytes )
+{
+	return parallel_convert_threshold.exchange( bytes );
+}
+
+}
+API_EXCLUDE_END;
+}
+}
@@ -2,9 +2,11 @@
 #define NUMERIC_CONVERT_HPP
 
 #include <limits>
+#include <algorithm>
 #include <assert.h>
 #include <boost/mpl/bool.hpp>
 #include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/function.hpp>
 #include "common.hpp"
 #include "valuearray.hpp"
 
@@ -190,11 +192,55 @@ DECL_SCALED_CONVERT( uint8_t, double );
 
 #undef DECL_CONVERT
 #undef DECL_SCALED_CONVERT
+#else //ISIS_USE_LIBOIL
+
+/// instruction sets the built-in conversion kernels are available for
+enum numeric_isa {generic_isa = 0, avx2_isa, avx512_isa};
+
+/// \returns the instruction set currently used for numeric conversions (the best one the cpu supports, unless setNumericIsa was used)
+numeric_isa getNumericIsa();
+/**
+ * Restrict the instruction set used for numeric conversions (mainly for testing and benchmarking).
+ * Must not be called while conversions are running.
+ * \returns false if the cpu does not support the requested instruction set (nothing is changed then)
+ */
+bool setNumericIsa( numeric_isa isa );
+const char *numericIsaName( numeric_isa isa );
+
+/// call MACRO(SRC,DST) for every pair of numeric types
+#define ISIS_NUMERIC_PAIRS(MACRO) \
+	ISIS_NUMERIC_PAIRS_TO(MACRO,int8_t) ISIS_NUMERIC_PAIRS_TO(MACRO,uint8_t) \
+	ISIS_NUMERIC_PAIRS_TO(MACRO,int16_t) ISIS_NUMERIC_PAIRS_TO(MACRO,uint16_t) \
+	ISIS_NUMERIC_PAIRS_TO(MACRO,int32_t) ISIS_NUMERIC_PAIRS_TO(MACRO,uint32_t) \
+	ISIS_NUMERIC_PAIRS_TO(MACRO,int64_t) ISIS_NUMERIC_PAIRS_TO(MACRO,uint64_t) \
+	ISIS_NUMERIC_PAIRS_TO(MACRO,float) ISIS_NUMERIC_PAIRS_TO(MACRO,double)
+#define ISIS_NUMERIC_PAIRS_TO(MACRO,DST) \
+	MACRO(int8_t,DST) MACRO(uint8_t,DST) MACRO(int16_t,DST) MACRO(uint16_t,DST) MACRO(int32_t,DST) \
+	MACRO(uint32_t,DST) MACRO(int64_t,DST) MACRO(uint64_t,DST) MACRO(float,DST) MACRO(double,DST)
+
+// the built-in kernels (see numeric_convert.cpp) select the instruction set at runtime
+#define DECL_CONVERT(SRC_TYPE,DST_TYPE)                                                                               \
+	template<> void numeric_convert_impl<SRC_TYPE,DST_TYPE>( const SRC_TYPE *src, DST_TYPE *dst, size_t count );     \
+	template<> void numeric_convert_impl<SRC_TYPE,DST_TYPE>( const SRC_TYPE *src, DST_TYPE *dst, size_t count, double scale, double offset );
+
+ISIS_NUMERIC_PAIRS( DECL_CONVERT )
+
+#undef DECL_CONVERT
 #endif //ISIS_USE_LIBOIL
 
 }
 /// @endcond _internal
 API_EXCLUDE_END;
+/**
+ * Check if getNumericScaling\<SRC,DST\> depends on the value range of the source.
+ * If it does not, the scaling will always be 1/0 and computing min/max of the source can be skipped.
+ * \param scaleopt enum to tweak the scaling strategy
+ */
+template<typename DST> bool numericScalingNeedsRange( autoscaleOption scaleopt )
+{
+	return scaleopt != noscale && std::numeric_limits<DST>::is_integer; // scaling into float is useless
+}
+
 /**
  * Computes scaling and offset between two scalar value domains.
  * The rules are:
@@ -217,7 +263,7 @@ getNumericScaling( const util::ValueBase &min, const util::ValueBase &max, autos
 {
 	double scale = 1.0;
 	double offset = 0.0;
-	bool doScale = ( scaleopt != noscale && std::numeric_limits<DST>::is_integer ); //only do scale if scaleopt!=noscale and the target is an integer (scaling into float is useless)
+	const bool doScale = numericScalingNeedsRange<DST>( scaleopt ); //only do scale if scaleopt!=noscale and the target is an integer
 
 	if ( scaleopt == autoscale && std::numeric_limits<SRC>::is_integer ) {
 		LOG( Debug, verbose_info ) << "Won't upscale, because the source datatype is discrete (" << util::Value<SRC>::staticName() << ")";
@@ -275,6 +321,73 @@ getNumericScaling( const util::ValueBase &min, const util::ValueBase &max, autos
 	return std::make_pair( scale, offset );
 }
 
+API_EXCLUDE_BEGIN;
+/// @cond _internal
+namespace _internal
+{
+/**
+ * Partition of an array into blocks for parallel conversion.
+ * All blocks but the first start at a page boundary of the destination, so no two threads write into the same page.
+ */
+struct ConvertBlocks {
+	size_t head; // length of the first block (up to the first page boundary)
+	size_t block; // length of all following blocks (except maybe the last)
+	size_t count; // amount of blocks, 0 means "do it serially"
+	size_t length; // length of the whole array
+	/// \returns start and length of block i
+	std::pair<size_t, size_t> operator[]( size_t i )const {
+		const size_t start = i ? head + ( i - 1 ) * block : 0;
+		const size_t end = std::min( head + i * block, length );
+		return std::make_pair( start, end - start );
+	}
+};
+/**
+ * Plan the parallel conversion of an array.
+ * \param dst the destination of the conversion
+ * \param length the length of the array in elements
+ * \param elem_size the size of an element of dst in bytes
+ * \returns a plan with count==0 if the array is too small (see setParallelConvertThreshold) or parallel execution is not enabled (see setExecutionPolicy)
+ */
+ConvertBlocks planConvertBlocks( const void *dst, size_t length, size_t elem_size );
+/// Run job for every block of the plan using util::ThreadPool::shared().
+void runConvertBlocks( const ConvertBlocks &blocks, const boost::function<void( size_t )> &job );
+/**
+ * Set the size (of the destination in bytes) from which on conversions are split up and run in parallel.
+ * \returns the previous threshold
+ */
+size_t setParallelConvertThreshold( size_t bytes );
+
+template<typename SRC, typename DST> struct ConvertBlockJob {
+	const SRC *src;
+	DST *dst;
+	const ConvertBlocks &blocks;
+	const bool scaled;
+	const double scale, offset;
+	ConvertBlockJob( const SRC *_src, DST *_dst, const ConvertBlocks &_blocks, bool _scaled, double _scale, double _offset ):
+		src( _src ), dst( _dst ), blocks( _blocks ), scaled( _scaled ), scale( _scale ), offset( _offset ) {}
+	void operator()( size_t i ) {
+		const std::pair<size_t, size_t> b = blocks[i];
+
+		if( scaled )
+			numeric_convert_impl( src + b.first, dst + b.first, b.second, scale, offset );
+		else
+			numeric_convert_impl( src + b.first, dst + b.first, b.second );
+	}
+};
+template<typename T> struct CopyBlockJob {
+	const T *src;
+	T *dst;
+	const ConvertBlocks &blocks;
+	CopyBlockJob( const T *_src, T *_dst, const ConvertBlocks &_blocks ): src( _src ), dst( _dst ), blocks( _blocks ) {}
+	void operator()( size_t i ) {
+		const std::pair<size_t, size_t> b = blocks[i];
+		numeric_copy_impl( src + b.first, dst + b.first, b.second );
+	}
+};
+}
+/// @endcond _internal
+API_EXCLUDE_END;
+
 /**
  * Converts data from 'src' to the type of 'dst' and stores them there.
  * If the value range defined by min and max does not fit into the domain of dst they will be scaled using the following rules:
@@ -285,6 +398,7 @@ getNumericScaling( const util::ValueBase &min, const util::ValueBase &max, autos
  * If dst is shorter than src, no conversion is done.
  * If src is shorter than dst a warning is send to CoreLog.
  * The conversion itself is equivalent to dst[i] = round( src[i] * scale + offset )
+ * If parallel execution is enabled (see setExecutionPolicy) big arrays are split up into page aligned blocks which are converted in parallel.
  * \param src data to be converted
  * \param dst target where to convert src to
  * \param size the amount of elements to be converted
@@ -293,14 +407,24 @@ getNumericScaling( const util::ValueBase &min, const util::ValueBase &max, autos
  */
 template<typename SRC, typename DST> void numeric_convert( const SRC *src, DST *dst, size_t size, const double scale, const double offset )
 {
-	if ( ( scale != 1. || offset ) )
+	const bool scaled = ( scale != 1. || offset );
+	const _internal::ConvertBlocks blocks = _internal::planConvertBlocks( dst, size, sizeof( DST ) );
+
+	if( blocks.count ) // big arrays are split up and converted in parallel
+		_internal::runConvertBlocks( blocks, _internal::ConvertBlockJob<SRC, DST>( src, dst, blocks, scaled, scale, offset ) );
+	else if ( scaled )
 		_internal::numeric_convert_impl( src, dst, size, scale, offset );
 	else
 		_internal::numeric_convert_impl( src, dst, size );
 }
 template<typename T> void numeric_copy( const T *src, T *dst, size_t size )
 {
-	_internal::numeric_copy_impl<T>( src, dst, size );
+	const _internal::ConvertBlocks blocks = _internal::planConvertBlocks( dst, size, sizeof( T ) );
+
+	if( blocks.count )
+		_internal::runConvertBlocks( blocks, _internal::CopyBlockJob<T>( src, dst, blocks ) );
+	else
+		_internal::numeric_copy_impl<T>( src, dst, size );
 }
 
 }
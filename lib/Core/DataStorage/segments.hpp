@@ -0,0 +1,204 @@
+/*
+    Copyright (C) 2010  reimer@cbs.mpg.de
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef SEGMENTS_HPP
+#define SEGMENTS_HPP
+
+#include <stddef.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <numeric>
+#include <assert.h>
+#include <boost/type_traits/remove_const.hpp>
+
+namespace isis
+{
+namespace data
+{
+
+/**
+ * A contiguous range of voxels of type T.
+ * Images are made of chunks, which each store their voxels in one contiguous block of memory.
+ * So the voxels of an image can be represented as a list of segments (see Image::getSegments).
+ * Looping through a segment is as fast as looping through an array, and can be optimized / vectorised by the compiler.
+ * The segment does not own the data, so it is only valid as long as the chunk it was taken from.
+ */
+template<typename T> class Segment
+{
+	T *m_begin, *m_end;
+public:
+	typedef T value_type;
+	typedef T *iterator;
+	typedef T &reference;
+
+	Segment(): m_begin( 0 ), m_end( 0 ) {}
+	Segment( T *begin, T *end ): m_begin( begin ), m_end( end ) {}
+	/// allow using a segment of non-const data as segment of const data
+	template<typename T2> Segment( const Segment<T2> &src ): m_begin( src.begin() ), m_end( src.end() ) {}
+
+	T *begin()const {return m_begin;}
+	T *end()const {return m_end;}
+	size_t size()const {return m_end - m_begin;}
+	bool empty()const {return m_end == m_begin;}
+	T &operator[]( size_t idx )const {return m_begin[idx];}
+};
+
+/**
+ * Segmented versions of common algorithms.
+ * They work on a list of segments (e.g. from Image::getSegments) and run the inner loop segment by segment,
+ * so they avoid the overhead of the random access iterators of the Image.
+ */
+namespace segmented
+{
+
+/// Run op on every value of the segments. \returns op (like std::for_each).
+template<typename T, typename OP> OP for_each( const std::vector<Segment<T> > &segments, OP op )
+{
+	for( typename std::vector<Segment<T> >::const_iterator s = segments.begin(); s != segments.end(); ++s )
+		op = std::for_each( s->begin(), s->end(), op );
+
+	return op;
+}
+
+/// Set all values of the segments to val.
+template<typename T> void fill( const std::vector<Segment<T> > &segments, const T &val )
+{
+	for( typename std::vector<Segment<T> >::const_iterator s = segments.begin(); s != segments.end(); ++s )
+		std::fill( s->begin(), s->end(), val );
+}
+
+/// Sum up all values of the segments starting with init. \returns the sum (like std::accumulate).
+template<typename T, typename R> R accumulate( const std::vector<Segment<T> > &segments, R init )
+{
+	for( typename std::vector<Segment<T> >::const_iterator s = segments.begin(); s != segments.end(); ++s )
+		init = std::accumulate( s->begin(), s->end(), init );
+
+	return init;
+}
+
+/**
+ * Get the smallest and the biggest value of the segments.
+ * The segments must not be empty.
+ * \returns a pair of the minimum and the maximum
+ */
+template<typename T> std::pair<typename boost::remove_const<T>::type, typename boost::remove_const<T>::type>
+minmax( const std::vector<Segment<T> > &segments )
+{
+	typedef typename boost::remove_const<T>::type value_type;
+	typename std::vector<Segment<T> >::const_iterator s = segments.begin();
+
+	while( s != segments.end() && s->empty() )
+		++s;
+
+	assert( s != segments.end() );
+	std::pair<value_type, value_type> ret( *s->begin(), *s->begin() );
+
+	for( ; s != segments.end(); ++s ) {
+		for( const T *i = s->begin(); i != s->end(); ++i ) {
+			if( *i < ret.first )ret.first = *i;
+
+			if( ret.second < *i )ret.second = *i;
+		}
+	}
+
+	return ret;
+}
+
+/// Copy all values of the segments to out. \returns the iterator behind the last copied value (like std::copy).
+template<typename T, typename OUT> OUT copy( const std::vector<Segment<T> > &segments, OUT out )
+{
+	for( typename std::vector<Segment<T> >::const_iterator s = segments.begin(); s != segments.end(); ++s )
+		out = std::copy( s->begin(), s->end(), out );
+
+	return out;
+}
+
+/**
+ * Store the result of op for every value of the segments in out.
+ * \returns the iterator behind the last stored value (like std::transform)
+ */
+template<typename T, typename OUT, typename OP> OUT transform( const std::vector<Segment<T> > &segments, OUT out, OP op )
+{
+	for( typename std::vector<Segment<T> >::const_iterator s = segments.begin(); s != segments.end(); ++s )
+		out = std::transform( s->begin(), s->end(), out, op );
+
+	return out;
+}
+
+/// @cond _internal
+namespace _internal
+{
+// runs func on the parts of two lists of segments which have the same position, but may have different boundaries
+template<typename T1, typename T2, typename FUNC> void zip( const std::vector<Segment<T1> > &first, const std::vector<Segment<T2> > &second, FUNC func )
+{
+	typename std::vector<Segment<T1> >::const_iterator s1 = first.begin();
+	typename std::vector<Segment<T2> >::const_iterator s2 = second.begin();
+	size_t pos1 = 0, pos2 = 0; // position in the current segments
+
+	while( s1 != first.end() && s2 != second.end() ) {
+		const size_t len = std::min( s1->size() - pos1, s2->size() - pos2 );
+		func( s1->begin() + pos1, s1->begin() + pos1 + len, s2->begin() + pos2 );
+
+		if( ( pos1 += len ) == s1->size() ) {
+			++s1;
+			pos1 = 0;
+		}
+
+		if( ( pos2 += len ) == s2->size() ) {
+			++s2;
+			pos2 = 0;
+		}
+	}
+}
+template<typename OP> struct TransformRange {
+	OP &op;
+	TransformRange( OP &_op ): op( _op ) {}
+	template<typename IN, typename OUT> void operator()( IN begin, IN end, OUT out )const {std::transform( begin, end, out, op );}
+};
+struct CopyRange {
+	template<typename IN, typename OUT> void operator()( IN begin, IN end, OUT out )const {std::copy( begin, end, out );}
+};
+}
+/// @endcond _internal
+
+/**
+ * Copy all values of the segments into the segments of dst.
+ * The boundaries of the segments do not need to match, so this can be used to copy between images with different chunks.
+ * Copying stops when the end of either segment list is reached.
+ */
+template<typename T1, typename T2> void copy( const std::vector<Segment<T1> > &src, const std::vector<Segment<T2> > &dst )
+{
+	_internal::zip( src, dst, _internal::CopyRange() );
+}
+
+/**
+ * Store the result of op for every value of the segments of src in the segments of dst.
+ * The boundaries of the segments do not need to match, and src and dst may be the same list.
+ * Processing stops when the end of either segment list is reached.
+ */
+template<typename T1, typename T2, typename OP> void transform( const std::vector<Segment<T1> > &src, const std::vector<Segment<T2> > &dst, OP op )
+{
+	_internal::zip( src, dst, _internal::TransformRange<OP>( op ) );
+}
+
+}
+}
+}
+
+#endif // SEGMENTS_HPP
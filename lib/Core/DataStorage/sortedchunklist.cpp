@@ -21,6 +21,8 @@
 #endif
 
 #include "sortedchunklist.hpp"
+#include "../CoreUtils/threadpool.hpp"
+#include <cmath>
 
 /// @cond _internal
 namespace isis
@@ -33,7 +35,7 @@ namespace _internal
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // sorting algorithm implementation
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-SortedChunkList::scalarPropCompare::scalarPropCompare( const util::PropertyMap::KeyType &prop_name ): propertyName( prop_name ) {}
+SortedChunkList::scalarPropCompare::scalarPropCompare( const util::PropertyMap::KeyType &prop_name ): propertyName( prop_name ), propertyPath( prop_name ) {}
 
 bool SortedChunkList::posCompare::operator()( const util::fvector3 &posA, const util::fvector3 &posB ) const
 {
@@ -44,6 +46,16 @@ bool SortedChunkList::posCompare::operator()( const util::fvector3 &posA, const
 
 	return false;
 }
+const float SortedChunkList::posHash::gridSize = 1e-3; // a thousandth of a millimeter
+size_t SortedChunkList::posHash::operator()( const util::fvector3 &a ) const
+{
+	size_t seed = 0;
+
+	for( size_t i = 0; i < 3; i++ )
+		boost::hash_combine( seed, std::floor( a[i] / gridSize ) + 0.f ); // + 0 to make -0 and 0 the same
+
+	return seed;
+}
 bool SortedChunkList::scalarPropCompare::operator()( const isis::util::PropertyValue &a, const isis::util::PropertyValue &b ) const
 {
 	const util::ValueBase &aScal = *a;
@@ -73,6 +85,37 @@ SortedChunkList::SortedChunkList( util::PropertyMap::KeyType comma_separated_equ
 	equalProps.insert( equalProps.end(), p_list.begin(), p_list.end() );
 }
 
+// the index points into chunks, so it cannot be copied - it has to be rebuilt for the copy
+SortedChunkList::SortedChunkList( const SortedChunkList &ref ):
+	secondarySort( ref.secondarySort ), primarySort( ref.primarySort ), chunks( ref.chunks ),
+	equalProps( ref.equalProps ), equalValues( ref.equalValues )
+{
+	reIndex();
+}
+SortedChunkList &SortedChunkList::operator=( const SortedChunkList &ref )
+{
+	secondarySort = ref.secondarySort;
+	primarySort = ref.primarySort;
+	chunks = ref.chunks;
+	equalProps = ref.equalProps;
+	equalValues = ref.equalValues;
+	reIndex();
+	return *this;
+}
+void SortedChunkList::resolveEqualValues( const Chunk &ch )
+{
+	equalValues.clear();
+	BOOST_FOREACH( const util::PropertyMap::PropPath & ref, equalProps ) {
+		equalValues.push_back( std::make_pair( ref, ch.hasProperty( ref ) ? ch.propertyValue( ref ) : util::PropertyValue() ) );
+	}
+}
+void SortedChunkList::reIndex()
+{
+	primaryIndex.clear();
+
+	for( PrimaryMap::iterator i = chunks.begin(); i != chunks.end(); ++i )
+		primaryIndex[i->first] = &i->second;
+}
 
 // low level finding
 boost::shared_ptr<Chunk> SortedChunkList::secondaryFind( const util::PropertyValue &key, SortedChunkList::SecondaryMap &map )
@@ -82,18 +125,23 @@ boost::shared_ptr<Chunk> SortedChunkList::secondaryFind( const util::PropertyVal
 }
 SortedChunkList::SecondaryMap *SortedChunkList::primaryFind( const util::fvector3 &key )
 {
-	const PrimaryMap::iterator found = chunks.find( key );
-	return found != chunks.end() ? &found->second : NULL;
+	const PrimaryIndex::iterator found = primaryIndex.find( key );
+	return found != primaryIndex.end() ? found->second : NULL;
 }
 
 // low level insert
 std::pair<boost::shared_ptr<Chunk>, bool> SortedChunkList::secondaryInsert( SecondaryMap &map, const Chunk &ch )
 {
-	util::PropertyMap::KeyType propName = map.key_comp().propertyName;
+	const scalarPropCompare &comp = secondarySort.top(); // the same as map.key_comp(), but that would be a copy
 
-	if( ch.hasProperty( propName ) ) {
+	if( ch.hasProperty( comp.propertyPath ) ) {
 		//check, if there is already a chunk
-		boost::shared_ptr<Chunk> &pos = map[ch.propertyValue( propName )];
+		const util::PropertyValue &key = ch.propertyValue( comp.propertyPath );
+		const SecondaryMap::value_type entry( key, boost::shared_ptr<Chunk>() );
+		// chunks usually come in ascending order - in that case inserting at the end is O(1)
+		boost::shared_ptr<Chunk> &pos = ( map.empty() || comp( map.rbegin()->first, key ) ) ?
+										map.insert( map.end(), entry )->second :
+										map.insert( entry ).first->second;
 		bool inserted = false;
 
 		//if not. put oures there
@@ -105,15 +153,13 @@ std::pair<boost::shared_ptr<Chunk>, bool> SortedChunkList::secondaryInsert( Seco
 		assert( pos ); // here it must have some content
 		return std::make_pair( pos, inserted );
 	} else {
-		LOG( Runtime, warning ) << "Cannot insert chunk. It's lacking the property " << util::MSubject( propName ) << " which is needed for primary sorting";
+		LOG( Runtime, warning ) << "Cannot insert chunk. It's lacking the property " << util::MSubject( comp.propertyName ) << " which is needed for primary sorting";
 		return std::pair<boost::shared_ptr<Chunk>, bool>( boost::shared_ptr<Chunk>(), false );
 	}
 }
-std::pair<boost::shared_ptr<Chunk>, bool> SortedChunkList::primaryInsert( const Chunk &ch )
+util::fvector3 SortedChunkList::positionKey( const Chunk &ch )
 {
 	static const util::PropertyMap::PropPath rowVecProb( "rowVec" ), columnVecProb( "columnVec" ), sliceVecProb( "sliceVec" ), indexOriginProb( "indexOrigin" );
-	LOG_IF( secondarySort.empty(), Debug, error ) << "There is no known secondary sorting left. Chunksort will fail.";
-	assert( ch.isValid() );
 	// compute the position of the chunk in the image space
 	// we dont have this position, but we have the position in scanner-space (indexOrigin)
 	const util::fvector3 &origin = ch.propertyValue( indexOriginProb ).castTo<util::fvector3>();
@@ -134,14 +180,24 @@ std::pair<boost::shared_ptr<Chunk>, bool> SortedChunkList::primaryInsert( const
 
 
 	// this is actually not the complete transform (it lacks the scaling for the voxel size), but its enough
-	const util::fvector3 key( origin.dot( rowVec ), origin.dot( columnVec ), origin.dot( sliceVec ) );
+	return util::fvector3( origin.dot( rowVec ), origin.dot( columnVec ), origin.dot( sliceVec ) );
+}
+std::pair<boost::shared_ptr<Chunk>, bool> SortedChunkList::primaryInsert( const Chunk &ch, const util::fvector3 &key )
+{
+	LOG_IF( secondarySort.empty(), Debug, error ) << "There is no known secondary sorting left. Chunksort will fail.";
+	assert( ch.isValid() );
 	const scalarPropCompare &secondaryComp = secondarySort.top();
 
 	// get the reference of the secondary map for "key" (create and insert a new if neccessary)
-	SecondaryMap &subMap = chunks.insert( std::make_pair( key, SecondaryMap( secondaryComp ) ) ).first->second;
+	SecondaryMap *subMap = primaryFind( key );
+
+	if( !subMap ) {
+		subMap = &chunks.insert( std::make_pair( key, SecondaryMap( secondaryComp ) ) ).first->second;
+		primaryIndex[key] = subMap;
+	}
 
 	// run insert on that
-	return secondaryInsert( subMap, ch ); // insert ch into the right secondary map
+	return secondaryInsert( *subMap, ch ); // insert ch into the right secondary map
 }
 
 // high level insert
@@ -154,23 +210,8 @@ bool SortedChunkList::insert( const Chunk &ch )
 
 	if( !isEmpty() ) {
 		// compare some attributes of the first chunk and the one which shall be inserted
-		Chunk &first = *( chunks.begin()->second.begin()->second );
-
-		if ( first.getSizeAsVector() != ch.getSizeAsVector() ) { // if they have different size - do not insert
-			LOG( Debug, verbose_info )
-					<< "Ignoring chunk with different size. (" << ch.getSizeAsString() << "!=" << first.getSizeAsString() << ")";
+		if( !fitsFirst( ch, *( chunks.begin()->second.begin()->second ) ) )
 			return false;
-		}
-
-		BOOST_FOREACH( util::PropertyMap::PropPath & ref, equalProps ) { // check all properties which where given to the constructor of the list
-			// if at least one of them has the property and they are not equal - do not insert
-			if ( ( first.hasProperty( ref ) || ch.hasProperty( ref ) ) && first.propertyValue( ref ) != ch.propertyValue( ref ) ) {
-				LOG( Debug, verbose_info )
-						<< "Ignoring chunk with different " << ref << ". Is " << util::MSubject( ch.propertyValue( ref ) )
-						<< " but chunks already in the list have " << util::MSubject( first.propertyValue( ref ) );
-				return false;
-			}
-		}
 	} else {
 		LOG( Debug, verbose_info ) << "Inserting 1st chunk";
 		std::stack<scalarPropCompare> backup = secondarySort;
@@ -180,7 +221,7 @@ bool SortedChunkList::insert( const Chunk &ch )
 			equalProps.push_back("indexOrigin");
 		}
 
-		while( !ch.hasProperty( secondarySort.top().propertyName ) ) {
+		while( !ch.hasProperty( secondarySort.top().propertyPath ) ) {
 			const util::PropertyMap::KeyType temp = secondarySort.top().propertyName;
 
 			if ( secondarySort.size() > 1 ) {
@@ -194,11 +235,39 @@ bool SortedChunkList::insert( const Chunk &ch )
 		}
 
 		LOG( Debug, info )  << "Using " << secondarySort.top().propertyName << " for secondary sorting, determined by the first chunk";
+		// all chunks in the list will have the same values, so they only need to be looked up once
+		// do that now - the chunks in the list might be stripped of their common properties later (see Image::deduplicateProperties)
+		resolveEqualValues( ch );
+	}
+
+	return insertAt( ch, positionKey( ch ) );
+}
+bool SortedChunkList::fitsFirst( const Chunk &ch, const Chunk &first )const
+{
+	if ( first.getSizeAsVector() != ch.getSizeAsVector() ) { // if they have different size - do not insert
+		LOG( Debug, verbose_info )
+				<< "Ignoring chunk with different size. (" << ch.getSizeAsString() << "!=" << first.getSizeAsString() << ")";
+		return false;
+	}
+
+	for( std::vector<std::pair<util::PropertyMap::PropPath, util::PropertyValue> >::const_iterator ref = equalValues.begin(); ref != equalValues.end(); ++ref ) {
+		// check all properties which where given to the constructor of the list
+		// if at least one of them has the property and they are not equal - do not insert
+		if ( ch.hasProperty( ref->first ) ? ref->second != ch.propertyValue( ref->first ) : !ref->second.isEmpty() ) {
+			LOG( Debug, verbose_info )
+					<< "Ignoring chunk with different " << ref->first << ". Is " << util::MSubject( ch.hasProperty( ref->first ) ? ch.propertyValue( ref->first ) : util::PropertyValue() )
+					<< " but chunks already in the list have " << util::MSubject( ref->second );
+			return false;
+		}
 	}
 
+	return true;
+}
+bool SortedChunkList::insertAt( const Chunk &ch, const util::fvector3 &key )
+{
 	const util::PropertyMap::KeyType &prop2 = secondarySort.top().propertyName;
 
-	std::pair<boost::shared_ptr<Chunk>, bool> inserted = primaryInsert( ch );
+	std::pair<boost::shared_ptr<Chunk>, bool> inserted = primaryInsert( ch, key );
 
 	LOG_IF( inserted.first && !inserted.second, Debug, verbose_info )
 			<< "Not inserting chunk because there is already a Chunk at the same position (" << ch.propertyValue( "indexOrigin" ) << ") with the equal property "
@@ -214,6 +283,118 @@ bool SortedChunkList::insert( const Chunk &ch )
 	return inserted.second;
 }
 
+// the checks Image::insertChunk does before inserting into its list
+static bool insertable( const Chunk &ch )
+{
+	LOG_IF( ch.getVolume() == 0, Runtime, error ) << "Cannot insert empty Chunk (Size is " << ch.getSizeAsString() << ").";
+	LOG_IF( ch.getVolume() && !ch.isValid(), Runtime, error ) << "Cannot insert invalid chunk. Missing properties: " << ch.getMissing();
+	return ch.getVolume() && ch.isValid();
+}
+
+struct SortedChunkList::bulkEntry {
+	util::fvector3 position;
+	util::PropertyValue secondary;
+	size_t index;
+	bulkEntry( const util::fvector3 &_position, const util::PropertyValue &_secondary, size_t _index ): position( _position ), secondary( _secondary ), index( _index ) {}
+};
+// sorts by the secondary key first, so all chunks of a position come in ascending order
+struct SortedChunkList::bulkCompare {
+	const scalarPropCompare &secondary;
+	const posCompare &primary;
+	bulkCompare( const scalarPropCompare &_secondary, const posCompare &_primary ): secondary( _secondary ), primary( _primary ) {}
+	bool operator()( const bulkEntry &a, const bulkEntry &b )const {
+		if( secondary( a.secondary, b.secondary ) )
+			return true;
+		else if( secondary( b.secondary, a.secondary ) )
+			return false;
+		else
+			return primary( a.position, b.position );
+	}
+};
+
+size_t SortedChunkList::insertBulk( std::vector<Chunk> &chunks )
+{
+	std::vector<size_t> rejected;
+	size_t inserted = 0, i = 0;
+
+	// the first chunk selects the secondary sorting and the values of equalProps (see insert)
+	for( ; isEmpty() && i < chunks.size(); i++ ) {
+		if( insertable( chunks[i] ) && insert( chunks[i] ) )
+			inserted++;
+		else
+			rejected.push_back( i );
+	}
+
+	if( i < chunks.size() ) {
+		const scalarPropCompare &secondaryComp = secondarySort.top();
+		// the first chunk is already in the list, so every chunk only has to be checked against it once
+		const Chunk &first = *( this->chunks.begin()->second.begin()->second );
+		std::vector<bulkEntry> entries;
+		entries.reserve( chunks.size() - i );
+
+		for( ; i < chunks.size(); i++ ) {
+			const Chunk &ch = chunks[i];
+
+			if( !insertable( ch ) || !fitsFirst( ch, first ) ) {
+				rejected.push_back( i );
+			} else if( !ch.hasProperty( secondaryComp.propertyPath ) ) {
+				LOG( Runtime, warning ) << "Cannot insert chunk. It's lacking the property " << util::MSubject( secondaryComp.propertyName ) << " which is needed for secondary sorting";
+				rejected.push_back( i );
+			} else
+				entries.push_back( bulkEntry( positionKey( ch ), ch.propertyValue( secondaryComp.propertyPath ), i ) );
+		}
+
+		const bulkCompare comp( secondaryComp, primarySort );
+		bool sorted = true;
+
+		for( size_t e = 1; sorted && e < entries.size(); e++ )
+			sorted = !comp( entries[e], entries[e - 1] );
+
+		if( !sorted ) // stable, so of equal chunks the first one will be inserted (as with inserting one by one)
+			std::stable_sort( entries.begin(), entries.end(), comp );
+
+		BOOST_FOREACH( const bulkEntry & entry, entries ) {
+			if( insertAt( chunks[entry.index], entry.position ) )
+				inserted++;
+			else
+				rejected.push_back( entry.index );
+		}
+	}
+
+	LOG_IF( !rejected.empty(), Debug, info ) << "Rejected " << rejected.size() << " of " << chunks.size() << " chunks";
+	std::sort( rejected.begin(), rejected.end() );
+	std::vector<Chunk> remaining;
+	remaining.reserve( rejected.size() );
+	BOOST_FOREACH( size_t r, rejected ) {
+		remaining.push_back( chunks[r] );
+	}
+	chunks.swap( remaining );
+	return inserted;
+}
+
+boost::shared_ptr<Chunk> SortedChunkList::append( const Chunk &ch )
+{
+	if( isEmpty() || chunks.size() > 1 ) {
+		LOG( Debug, info ) << "Cannot append to a list with " << chunks.size() << " positions";
+		return boost::shared_ptr<Chunk>();
+	}
+
+	SecondaryMap &map = chunks.begin()->second;
+	const scalarPropCompare &comp = secondarySort.top();
+
+	if( !ch.hasProperty( comp.propertyPath ) || !comp( map.rbegin()->first, ch.propertyValue( comp.propertyPath ) ) ) {
+		LOG( Debug, info ) << "Cannot append chunk, its " << comp.propertyName << " does not come after " << map.rbegin()->first;
+		return boost::shared_ptr<Chunk>();
+	}
+
+	if( primaryFind( positionKey( ch ) ) != &map ) {
+		LOG( Debug, info ) << "Cannot append chunk at " << ch.propertyValue( "indexOrigin" ) << ", it is not at the position of the other chunks";
+		return boost::shared_ptr<Chunk>();
+	}
+
+	return insert( ch ) ? map.rbegin()->second : boost::shared_ptr<Chunk>();
+}
+
 void SortedChunkList::addSecondarySort( const util::PropertyMap::KeyType &cmp )
 {
 	secondarySort.push( scalarPropCompare( cmp ) );
@@ -225,6 +406,8 @@ bool SortedChunkList::isEmpty()const
 void SortedChunkList::clear()
 {
 	chunks.clear();
+	primaryIndex.clear();
+	equalValues.clear();
 }
 bool SortedChunkList::isRectangular()
 {
@@ -270,11 +453,30 @@ std::vector< boost::shared_ptr< Chunk > > SortedChunkList::getLookup()
 		return std::vector< boost::shared_ptr< Chunk > >();
 }
 
-void SortedChunkList::transform( chunkPtrOperator &op )
+struct SortedChunkList::transformJob {
+	chunkPtrOperator &op;
+	const std::vector<boost::shared_ptr<Chunk>*> &entries;
+	transformJob( chunkPtrOperator &_op, const std::vector<boost::shared_ptr<Chunk>*> &_entries ): op( _op ), entries( _entries ) {}
+	void operator()( size_t i ) {
+		*entries[i] = op( *entries[i] );
+	}
+};
+
+void SortedChunkList::transform( chunkPtrOperator &op, execution_policy policy )
 {
-	BOOST_FOREACH( PrimaryMap::reference outer, chunks ) {
-		BOOST_FOREACH( SecondaryMap::reference inner, outer.second ) {
-			inner.second = op( inner.second );
+	if( policy == parallel_execution ) {
+		std::vector<boost::shared_ptr<Chunk>*> entries;
+		BOOST_FOREACH( PrimaryMap::reference outer, chunks ) {
+			BOOST_FOREACH( SecondaryMap::reference inner, outer.second ) {
+				entries.push_back( &inner.second );
+			}
+		}
+		util::ThreadPool::shared().parallelFor( entries.size(), transformJob( op, entries ) );
+	} else {
+		BOOST_FOREACH( PrimaryMap::reference outer, chunks ) {
+			BOOST_FOREACH( SecondaryMap::reference inner, outer.second ) {
+				inner.second = op( inner.second );
+			}
 		}
 	}
 }
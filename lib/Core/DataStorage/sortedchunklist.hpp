@@ -23,6 +23,7 @@
 #include "../CoreUtils/vector.hpp"
 #include <stack>
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 /// @cond _internal
 namespace isis
@@ -42,12 +43,18 @@ class SortedChunkList
 public:
 	struct scalarPropCompare {
 		util::PropertyMap::KeyType propertyName;
+		util::PropertyMap::PropPath propertyPath; // parsed once, as its used for every chunk
 		scalarPropCompare( const util::PropertyMap::KeyType &prop_name );
 		bool operator()( const util::PropertyValue &a, const util::PropertyValue &b ) const;
 	};
 	struct posCompare {
 		bool operator()( const util::fvector3 &a, const util::fvector3 &b ) const;
 	};
+	/// hashes positions by putting them into cells of a grid (equal positions will allways end up in the same cell)
+	struct posHash {
+		static const float gridSize;
+		size_t operator()( const util::fvector3 &a ) const;
+	};
 	struct chunkPtrOperator {
 		virtual boost::shared_ptr<Chunk> operator()( const boost::shared_ptr<Chunk> &ptr ) = 0;
 		virtual ~chunkPtrOperator();
@@ -56,19 +63,39 @@ private:
 	typedef std::map<util::PropertyValue, boost::shared_ptr<Chunk>, scalarPropCompare> SecondaryMap;
 	typedef std::map<util::fvector3, SecondaryMap, posCompare> PrimaryMap;
 
+	// index for the primary map - most chunks are inserted at known positions, this finds them without traversing the map
+	typedef boost::unordered_map<util::fvector3, SecondaryMap *, posHash> PrimaryIndex;
+
+	struct bulkEntry;
+	struct bulkCompare;
+
 	std::stack<scalarPropCompare> secondarySort;
 	posCompare primarySort;
 	PrimaryMap chunks;
+	PrimaryIndex primaryIndex;
+	struct transformJob;
+
+	void reIndex(); // rebuild primaryIndex from chunks
 
 	// low level finding
 	boost::shared_ptr<Chunk> secondaryFind( const util::PropertyValue &key, SecondaryMap &map );
 	SecondaryMap *primaryFind( const util::fvector3 &key );
 
+	// computes the position of the chunk in image space, which is used for primary sorting
+	static util::fvector3 positionKey( const Chunk &ch );
+
 	// low level inserting
 	std::pair<boost::shared_ptr<Chunk>, bool> secondaryInsert( SecondaryMap &map, const Chunk &ch );
-	std::pair<boost::shared_ptr<Chunk>, bool> primaryInsert( const Chunk &ch );
+	std::pair<boost::shared_ptr<Chunk>, bool> primaryInsert( const Chunk &ch, const util::fvector3 &key );
+	bool insertAt( const Chunk &ch, const util::fvector3 &key ); // primaryInsert with logging of rejected duplicates
+
+	// checks size and equalValues of ch against the first chunk of the list
+	bool fitsFirst( const Chunk &ch, const Chunk &first )const;
 
 	std::list<util::PropertyMap::PropPath> equalProps;
+	// the values of equalProps in the chunks of the list (resolved once from the first chunk - they are equal for all others)
+	std::vector<std::pair<util::PropertyMap::PropPath, util::PropertyValue> > equalValues;
+	void resolveEqualValues( const Chunk &ch );
 public:
 
 	//initialisation
@@ -76,6 +103,8 @@ public:
 	 * Creates a sorted list and sets primary sorting as well as properties which should be equal across all chunks.
 	 */
 	SortedChunkList( util::PropertyMap::KeyType comma_separated_equal_props );
+	SortedChunkList( const SortedChunkList &ref );
+	SortedChunkList &operator=( const SortedChunkList &ref );
 
 	/**
 	 * Adds a property for secondary sorting.
@@ -85,12 +114,35 @@ public:
 
 	// utils
 
-	///runs op on all entries of the list (the order is not defined) and replaces the entries by the return value
-	void transform( chunkPtrOperator &op );
+	/**
+	 * Runs op on all entries of the list (the order is not defined) and replaces the entries by the return value.
+	 * \param op the operation to be run (if policy is parallel_execution, it must be safe to be called concurrently)
+	 * \param policy parallel_execution to run op on multiple entries at once (default_execution is treated as sequential)
+	 */
+	void transform( chunkPtrOperator &op, execution_policy policy = sequential_execution );
 
 	/// Tries to insert a chunk (a cheap copy of the chunk is done when inserted)
 	bool insert( const Chunk &ch );
 
+	/**
+	 * Tries to insert all chunks of a vector (cheap copies of the chunks are done when inserted).
+	 * The sort keys of all chunks are computed once and the chunks are inserted in sorted order, which makes
+	 * inserting them much cheaper than in random order. If the chunks are sorted already, sorting is skipped.
+	 * The result is the same as inserting the chunks one by one, of equal chunks the first one in the vector is used.
+	 * \param chunks the chunks to be inserted, afterwards it contains the rejected chunks (in their original order)
+	 * \returns the amount of inserted chunks
+	 */
+	size_t insertBulk( std::vector<Chunk> &chunks );
+
+	/**
+	 * Tries to insert a chunk behind all other chunks of the list (a cheap copy of the chunk is done when inserted).
+	 * This only works if all chunks of the list are at the same position (e.g. they are volumes).
+	 * The chunk must be at that position as well and come after the last chunk there in the secondary sorting.
+	 * Otherwise, and if insert would reject it, the chunk is not inserted.
+	 * \returns the inserted chunk or an empty pointer if the chunk was not inserted
+	 */
+	boost::shared_ptr<Chunk> append( const Chunk &ch );
+
 	/// \returns true if there is no chunk in the list
 	bool isEmpty()const;
 
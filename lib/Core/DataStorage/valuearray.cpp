@@ -18,6 +18,9 @@ template<> scaling_pair ValueArray<std::complex<double> >::getScalingTo( unsigne
 #ifdef __SSE2__
 
 #include <emmintrin.h>
+#ifdef __SSE4_1__
+#include <smmintrin.h>
+#endif
 namespace _internal
 {
 
@@ -66,151 +69,156 @@ DEF_VECTOR_UI( uint8_t, 8 );
 DEF_VECTOR_UI( uint16_t, 16 );
 DEF_VECTOR_UI( uint32_t, 32 );
 
-
-
-////////////////////////////////////////////
-// optimized min/max function for integers /
-////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////
+// min/max operations on vector registers for the supported types /
+////////////////////////////////////////////////////////////////////
+
+// common base for all integer types
+template<typename T> struct _IntMinMaxOpBase {
+	typedef __m128i reg;
+	static reg load( const T *p ) {return _mm_loadu_si128( reinterpret_cast<const __m128i *>( p ) );}
+	static void store( reg a, T *p ) {_mm_storeu_si128( reinterpret_cast<__m128i *>( p ), a );}
+	static reg set1( T val ) {
+		_VectorUnion<T> ret;
+		std::fill( ret.vec.elem, ret.vec.elem + 16 / sizeof( T ), val );
+		return ret.vec.reg;
+	}
+	// integers don't have inf or nan - nothing to filter out
+	static reg forMin( reg a ) {return a;}
+	static reg forMax( reg a ) {return a;}
+};
 
 // generic fallback using cmpgt and some bitmask voodoo
-template<typename T> std::pair<__m128i, __m128i> _getMinMaxBlockLoop( const __m128i *data, size_t blocks )
-{
-	std::pair<__m128i, __m128i> ret( _mm_loadu_si128( data ), _mm_loadu_si128( data ) );
-	LOG( Runtime, verbose_info ) << "using optimized min/max computation for " << util::Value<T>::staticName() << " (masked mode)";
-	static const __m128i one = _mm_set_epi16( -1, -1, -1, -1, -1, -1, -1, -1 );
-
-	while ( --blocks ) {
-		const __m128i at = _mm_loadu_si128( ++data );
-
-		const __m128i less_mask = _TypeVector<T>::lt( at, ret.first );
-		const __m128i greater_mask = _TypeVector<T>::gt( at, ret.second );
-
-		ret.first =
-			( ret.first & ( less_mask ^ one ) ) //remove bigger values from current min
-			| ( at & less_mask ); //put in the lesser values from at
-		ret.second =
-			( ret.second & ( greater_mask ^ one ) ) //remove lesser values from current max
-			| ( at & greater_mask ); //put in the bigger values from at
+template<typename T> struct _MinMaxOp: _IntMinMaxOpBase<T> {
+	typedef __m128i reg;
+	static const char *mode() {return "masked mode";}
+	static reg min( reg a, reg b ) {
+		const reg less_mask = _TypeVector<T>::lt( b, a );
+		return _mm_or_si128( _mm_andnot_si128( less_mask, a ), _mm_and_si128( less_mask, b ) );
 	}
-
-	return ret;
-}
+	static reg max( reg a, reg b ) {
+		const reg greater_mask = _TypeVector<T>::gt( b, a );
+		return _mm_or_si128( _mm_andnot_si128( greater_mask, a ), _mm_and_si128( greater_mask, b ) );
+	}
+};
 
 // specialiced versions using processor opcodes for min/max
-template<> std::pair<__m128i, __m128i> _getMinMaxBlockLoop<uint8_t>( const __m128i *data, size_t blocks ) //PMAXUB
-{
-	std::pair<__m128i, __m128i> ret( _mm_loadu_si128( data ), _mm_loadu_si128( data ) );
-	LOG( Runtime, verbose_info ) << "using optimized min/max computation for " << util::Value<uint8_t>::staticName() << " (direct mode)";
-
-	while ( --blocks ) {
-		const __m128i at = _mm_loadu_si128( ++data );
-		ret.first = _mm_min_epu8( ret.first, at );
-		ret.second = _mm_max_epu8( ret.second, at );
+#define DEF_MINMAX_OP(TYPE,MIN,MAX)                                     \
+	template<> struct _MinMaxOp<TYPE>: _IntMinMaxOpBase<TYPE>{           \
+		static const char *mode(){return "direct mode";}                 \
+		static reg min( reg a, reg b ) {return MIN( a, b );}              \
+		static reg max( reg a, reg b ) {return MAX( a, b );}              \
 	}
 
-	return ret;
-}
-template<> std::pair<__m128i, __m128i> _getMinMaxBlockLoop<int16_t>( const __m128i *data, size_t blocks ) //PMAXSW
-{
-	std::pair<__m128i, __m128i> ret( _mm_loadu_si128( data ), _mm_loadu_si128( data ) );
-	LOG( Runtime, verbose_info ) << "using optimized min/max computation for " << util::Value<int16_t>::staticName() << " (direct mode)";
+DEF_MINMAX_OP( uint8_t, _mm_min_epu8, _mm_max_epu8 ); //PMAXUB
+DEF_MINMAX_OP( int16_t, _mm_min_epi16, _mm_max_epi16 ); //PMAXSW
+#ifdef __SSE4_1__
+DEF_MINMAX_OP( int8_t, _mm_min_epi8, _mm_max_epi8 ); //PMAXSB
+DEF_MINMAX_OP( uint16_t, _mm_min_epu16, _mm_max_epu16 ); //PMAXUW
+DEF_MINMAX_OP( int32_t, _mm_min_epi32, _mm_max_epi32 ); //PMAXSD
+DEF_MINMAX_OP( uint32_t, _mm_min_epu32, _mm_max_epu32 ); //PMAXUD
+#endif
 
-	while ( --blocks ) {
-		const __m128i at = _mm_loadu_si128( ++data );
-		ret.first = _mm_min_epi16( ret.first, at );
-		ret.second = _mm_max_epi16( ret.second, at );
+// floating point versions, inf and nan are replaced by values which won't change the result
+#define DEF_MINMAX_OP_FLOAT(TYPE,REG,KEY,INT_TYPE,ABSMASK)                                          \
+	template<> struct _MinMaxOp<TYPE>{                                                               \
+		typedef REG reg;                                                                             \
+		static const char *mode(){return "direct mode";}                                             \
+		static reg load( const TYPE *p ) {return _mm_loadu_ ## KEY( p );}                             \
+		static void store( reg a, TYPE *p ) {_mm_storeu_ ## KEY( p, a );}                             \
+		static reg set1( TYPE val ) {return _mm_set1_ ## KEY( val );}                                 \
+		static reg min( reg a, reg b ) {return _mm_min_ ## KEY( a, b );}                              \
+		static reg max( reg a, reg b ) {return _mm_max_ ## KEY( a, b );}                              \
+		static reg valid( reg a ) { /* |a|<=max is false for inf and nan */                          \
+			const reg abs = _mm_and_ ## KEY( a, _mm_castsi128_ ## KEY( _mm_set1_ ## INT_TYPE( ABSMASK ) ) ); \
+			return _mm_cmple_ ## KEY( abs, set1( std::numeric_limits<TYPE>::max() ) );                \
+		}                                                                                            \
+		static reg replaceInvalid( reg a, TYPE by ) {                                                \
+			const reg mask = valid( a );                                                             \
+			return _mm_or_ ## KEY( _mm_and_ ## KEY( mask, a ), _mm_andnot_ ## KEY( mask, set1( by ) ) ); \
+		}                                                                                            \
+		static reg forMin( reg a ) {return replaceInvalid( a, std::numeric_limits<TYPE>::max() );}   \
+		static reg forMax( reg a ) {return replaceInvalid( a, -std::numeric_limits<TYPE>::max() );}  \
 	}
 
-	return ret;
-}
-
-#ifdef __SSE4_1__
-#include <smmintrin.h>
-template<> std::pair<__m128i, __m128i> _getMinMaxBlockLoop<int8_t>( const __m128i *data, size_t blocks ) //PMAXSB
-{
-	std::pair<__m128i, __m128i> ret( _mm_loadu_si128( data ), _mm_loadu_si128( data ) );
-	LOG( Runtime, verbose_info ) << "using optimized min/max computation for " << util::Value<int8_t>::staticName() << " (direct mode)";
+DEF_MINMAX_OP_FLOAT( float, __m128, ps, epi32, 0x7fffffff );
+DEF_MINMAX_OP_FLOAT( double, __m128d, pd, epi64x, 0x7fffffffffffffffLL );
 
-	while ( --blocks ) {
-		const __m128i at = _mm_loadu_si128( ++data );
-		ret.first = _mm_min_epi8( ret.first, at );
-		ret.second = _mm_max_epi8( ret.second, at );
-	}
+#undef DEF_MINMAX_OP
+#undef DEF_MINMAX_OP_FLOAT
 
-	return ret;
-}
-template<> std::pair<__m128i, __m128i> _getMinMaxBlockLoop<uint16_t>( const __m128i *data, size_t blocks ) //PMAXUW
+/*
+ * Compute min/max of each of the CHANNELS interleaved channels in one pass.
+ * The blocks processed per iteration are a multiple of CHANNELS, so every lane of the vector registers
+ * always holds values of the same channel and the lanes only have to be sorted into the channels at the end.
+ */
+template<typename T, uint8_t CHANNELS> void _getMinMaxChannels( const T *data, size_t len, T *min, T *max )
 {
-	std::pair<__m128i, __m128i> ret( _mm_loadu_si128( data ), _mm_loadu_si128( data ) );
-	LOG( Runtime, verbose_info ) << "using optimized min/max computation for " << util::Value<uint16_t>::staticName() << " (direct mode)";
-
-	while ( --blocks ) {
-		const __m128i at = _mm_loadu_si128( ++data );
-		ret.first = _mm_min_epu16( ret.first, at );
-		ret.second = _mm_max_epu16( ret.second, at );
+	typedef _MinMaxOp<T> Op;
+	static const size_t lanes = 16 / sizeof( T );
+	static const size_t regs = CHANNELS == 1 ? 4 : CHANNELS; // use multiple independent registers if there is only one channel
+	static const size_t step = lanes * regs;
+	const size_t blocks = len / step;
+
+	LOG( Runtime, verbose_info ) << "using optimized min/max computation for " << ( int )CHANNELS << " channel(s) of " << util::Value<T>::staticName() << " (" << Op::mode() << ")";
+
+	std::fill( min, min + CHANNELS, std::numeric_limits<T>::max() );
+	std::fill( max, max + CHANNELS, lowestValue<T>() );
+
+	if( blocks ) {
+		typename Op::reg vmin[regs], vmax[regs];
+		std::fill( vmin, vmin + regs, Op::set1( std::numeric_limits<T>::max() ) );
+		std::fill( vmax, vmax + regs, Op::set1( lowestValue<T>() ) );
+
+		for( const T *const end = data + blocks * step; data < end; data += step ) {
+			for( size_t r = 0; r < regs; r++ ) {
+				const typename Op::reg at = Op::load( data + r * lanes );
+				vmin[r] = Op::min( vmin[r], Op::forMin( at ) );
+				vmax[r] = Op::max( vmax[r], Op::forMax( at ) );
+			}
+		}
+
+		// sort the lanes into their channels
+		T lmin[lanes], lmax[lanes];
+
+		for( size_t r = 0; r < regs; r++ ) {
+			Op::store( vmin[r], lmin );
+			Op::store( vmax[r], lmax );
+
+			for( size_t l = 0; l < lanes; l++ ) {
+				const size_t channel = ( r * lanes + l ) % CHANNELS;
+				min[channel] = std::min( min[channel], lmin[l] );
+				max[channel] = std::max( max[channel], lmax[l] );
+			}
+		}
+
+		len -= blocks * step;
 	}
 
-	return ret;
-}
-template<> std::pair<__m128i, __m128i> _getMinMaxBlockLoop<int32_t>( const __m128i *data, size_t blocks ) //PMAXSD
-{
-	std::pair<__m128i, __m128i> ret( _mm_loadu_si128( data ), _mm_loadu_si128( data ) );
-	LOG( Runtime, verbose_info ) << "using optimized min/max computation for " << util::Value<int32_t>::staticName() << " (direct mode)";
+	// the remaining values (data now points to the first of them, which is always of the first channel)
+	for( size_t i = 0; i < len; i++ ) {
+		const size_t channel = i % CHANNELS;
 
-	while ( --blocks ) {
-		const __m128i at = _mm_loadu_si128( ++data );
-		ret.first = _mm_min_epi32( ret.first, at );
-		ret.second = _mm_max_epi32( ret.second, at );
-	}
+		if( !validForMinMax( data[i] ) )
+			continue;
 
-	return ret;
-}
-template<> std::pair<__m128i, __m128i> _getMinMaxBlockLoop<uint32_t>( const __m128i *data, size_t blocks ) //PMAXSD
-{
-	std::pair<__m128i, __m128i> ret( _mm_loadu_si128( data ), _mm_loadu_si128( data ) );
-	LOG( Runtime, verbose_info ) << "using optimized min/max computation for " << util::Value<uint32_t>::staticName() << " (direct mode)";
+		if( data[i] < min[channel] )min[channel] = data[i];
 
-	while ( --blocks ) {
-		const __m128i at = _mm_loadu_si128( ++data );
-		ret.first = _mm_min_epu32( ret.first, at );
-		ret.second = _mm_max_epu32( ret.second, at );
+		if( data[i] > max[channel] )max[channel] = data[i];
 	}
-
-	return ret;
 }
-#endif
-
 template<typename T> std::pair<T, T> _getMinMax( const T *data, size_t len )
 {
-	size_t blocks = len / ( 16 / sizeof( T ) );
-
-	T bmin = std::numeric_limits<T>::max();
-	T bmax = std::numeric_limits<T>::min();
-
-	if( blocks ) { // if there are 16byte-blocks of values
-		std::pair<__m128i, __m128i> minmax = _getMinMaxBlockLoop<T>( reinterpret_cast<const __m128i *>( data ), blocks );
-		// compute the min/max of the blocks bmin/bmax
-		const _VectorUnion<T> smin = minmax.first;
-		const _VectorUnion<T> smax = minmax.second;
-		bmin = *std::min_element( smin.vec.elem, smin.vec.elem + 16 / sizeof( T ) );
-		bmax = *std::max_element( smax.vec.elem, smax.vec.elem + 16 / sizeof( T ) );
-	}
-
-	// if there are some remaining elements
-	if( data + blocks * 16 / sizeof( T ) < data + len ) {
-		const T rmin = *std::min_element( data + blocks * 16 / sizeof( T ), data + len );
-		const T rmax = *std::max_element( data + blocks * 16 / sizeof( T ), data + len );
-		return std::pair<T, T>( std::min( bmin, rmin ), std::max( bmax, rmax ) );
-	} else {
-		return std::pair<T, T>( bmin, bmax );
-	}
+	std::pair<T, T> ret;
+	_getMinMaxChannels<T, 1>( data, len, &ret.first, &ret.second );
+	return ret;
 }
 
 API_EXCLUDE_END;
 
-////////////////////////////////////////////////
-// specialize calcMinMax for (u)int(8,16,32)_t /
-////////////////////////////////////////////////
+////////////////////////////////////////////////////////////////
+// specialize calcMinMax for (u)int(8,16,32)_t, float, double /
+////////////////////////////////////////////////////////////////
 
 template<> std::pair< uint8_t,  uint8_t> calcMinMax< uint8_t, 1>( const  uint8_t *data, size_t len ) {return _getMinMax( data, len );}
 template<> std::pair<uint16_t, uint16_t> calcMinMax<uint16_t, 1>( const uint16_t *data, size_t len ) {return _getMinMax( data, len );}
@@ -220,6 +228,18 @@ template<> std::pair< int8_t,  int8_t> calcMinMax< int8_t, 1>( const  int8_t *da
 template<> std::pair<int16_t, int16_t> calcMinMax<int16_t, 1>( const int16_t *data, size_t len ) {return _getMinMax( data, len );}
 template<> std::pair<int32_t, int32_t> calcMinMax<int32_t, 1>( const int32_t *data, size_t len ) {return _getMinMax( data, len );}
 
+template<> std::pair<float, float> calcMinMax<float, 1>( const float *data, size_t len ) {return _getMinMax( data, len );}
+template<> std::pair<double, double> calcMinMax<double, 1>( const double *data, size_t len ) {return _getMinMax( data, len );}
+
+/////////////////////////////////////////////////////////////////////////////
+// specialize calcMinMaxChannels for color24, color48 and the complex types /
+/////////////////////////////////////////////////////////////////////////////
+
+template<> void calcMinMaxChannels< uint8_t, 3>( const  uint8_t *data, size_t len,  uint8_t *min,  uint8_t *max ) {_getMinMaxChannels<uint8_t, 3>( data, len, min, max );}
+template<> void calcMinMaxChannels<uint16_t, 3>( const uint16_t *data, size_t len, uint16_t *min, uint16_t *max ) {_getMinMaxChannels<uint16_t, 3>( data, len, min, max );}
+template<> void calcMinMaxChannels<float, 2>( const float *data, size_t len, float *min, float *max ) {_getMinMaxChannels<float, 2>( data, len, min, max );}
+template<> void calcMinMaxChannels<double, 2>( const double *data, size_t len, double *min, double *max ) {_getMinMaxChannels<double, 2>( data, len, min, max );}
+
 } //namepace _internal
 #else
 #warning Optimized min/max functions are not used because SSE2 is not enabled
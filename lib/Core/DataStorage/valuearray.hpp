@@ -27,6 +27,10 @@
 #include "../CoreUtils/value.hpp"
 #include "common.hpp"
 #include <boost/type_traits/remove_const.hpp>
+#include <boost/type_traits/add_pointer.hpp>
+#include <boost/type_traits/is_arithmetic.hpp>
+#include <boost/mpl/for_each.hpp>
+#include <boost/mpl/filter_view.hpp>
 #include "endianess.hpp"
 
 namespace isis
@@ -37,34 +41,64 @@ namespace data
 namespace _internal
 {
 /// @cond _internal
-template<typename T, uint8_t STEPSIZE> std::pair<T, T> calcMinMax( const T *data, size_t len )
+/// \returns the lowest finite value of T (for types with denormalization min is _not_ the lowest value)
+template<typename T> T lowestValue()
 {
 	BOOST_STATIC_ASSERT( std::numeric_limits<T>::has_denorm != std::denorm_indeterminate ); //well we're pretty f**ed in this case
-	std::pair<T, T> result(
-		std::numeric_limits<T>::max(),
-		std::numeric_limits<T>::has_denorm ? -std::numeric_limits<T>::max() : std::numeric_limits<T>::min() //for types with denormalization min is _not_ the lowest value
-	);
+	return std::numeric_limits<T>::has_denorm ? -std::numeric_limits<T>::max() : std::numeric_limits<T>::min();
+}
+/// \returns false for values which shall be ignored by the min/max computation (inf and nan)
+template<typename T> bool validForMinMax( const T &val )
+{
+	return !std::numeric_limits<T>::has_infinity || ( val <= std::numeric_limits<T>::max() && val >= -std::numeric_limits<T>::max() );
+}
+
+template<typename T, uint8_t STEPSIZE> std::pair<T, T> calcMinMax( const T *data, size_t len )
+{
+	std::pair<T, T> result( std::numeric_limits<T>::max(), lowestValue<T>() );
 	LOG( Runtime, verbose_info ) << "using generic min/max computation for " << util::Value<T>::staticName();
 
 	for ( const T *i = data; i < data + len; i += STEPSIZE ) {
-		if(
-			std::numeric_limits<T>::has_infinity &&
-			( *i == std::numeric_limits<T>::infinity() || *i == -std::numeric_limits<T>::infinity() )
-		)
-			continue; // skip this one if its inf
+		if( !validForMinMax( *i ) )
+			continue; // skip this one if its inf or nan
 
-		if ( *i > result.second )result.second = *i; //*i is the new max if its bigger than the current (gets rid of nan as well)
+		if ( *i > result.second )result.second = *i; //*i is the new max if its bigger than the current
 
-		if ( *i < result.first )result.first = *i; //*i is the new min if its smaller than the current (gets rid of nan as well)
+		if ( *i < result.first )result.first = *i; //*i is the new min if its smaller than the current
 	}
 
 	return result;
 }
 
+/**
+ * Compute min/max of every channel of interleaved data in one pass.
+ * \param data the interleaved values (e.g. the r,g,b values of colors)
+ * \param len the amount of values (not elements) - must be a multiple of CHANNELS
+ * \param min array of CHANNELS values to store the minimum of each channel in
+ * \param max array of CHANNELS values to store the maximum of each channel in
+ */
+template<typename T, uint8_t CHANNELS> void calcMinMaxChannels( const T *data, size_t len, T *min, T *max )
+{
+	LOG( Runtime, verbose_info ) << "using generic min/max computation for " << ( int )CHANNELS << " channels of " << util::Value<T>::staticName();
+	std::fill( min, min + CHANNELS, std::numeric_limits<T>::max() );
+	std::fill( max, max + CHANNELS, lowestValue<T>() );
+
+	for ( const T *i = data; i < data + len; i += CHANNELS ) {
+		for( uint_fast8_t c = 0; c < CHANNELS; c++ ) {
+			if( !validForMinMax( i[c] ) )
+				continue;
+
+			if ( i[c] > max[c] )max[c] = i[c];
+
+			if ( i[c] < min[c] )min[c] = i[c];
+		}
+	}
+}
+
 #ifdef __SSE2__
-////////////////////////////////////////////////
-// specialize calcMinMax for (u)int(8,16,32)_t /
-////////////////////////////////////////////////
+////////////////////////////////////////////////////////////
+// specialize calcMinMax for (u)int(8,16,32)_t, float, double /
+////////////////////////////////////////////////////////////
 
 template<> std::pair< uint8_t,  uint8_t> calcMinMax< uint8_t, 1>( const  uint8_t *data, size_t len );
 template<> std::pair<uint16_t, uint16_t> calcMinMax<uint16_t, 1>( const uint16_t *data, size_t len );
@@ -73,6 +107,17 @@ template<> std::pair<uint32_t, uint32_t> calcMinMax<uint32_t, 1>( const uint32_t
 template<> std::pair< int8_t,  int8_t> calcMinMax< int8_t, 1>( const  int8_t *data, size_t len );
 template<> std::pair<int16_t, int16_t> calcMinMax<int16_t, 1>( const int16_t *data, size_t len );
 template<> std::pair<int32_t, int32_t> calcMinMax<int32_t, 1>( const int32_t *data, size_t len );
+
+template<> std::pair<float, float> calcMinMax<float, 1>( const float *data, size_t len );
+template<> std::pair<double, double> calcMinMax<double, 1>( const double *data, size_t len );
+
+/////////////////////////////////////////////////////////////////////////////
+// specialize calcMinMaxChannels for color24, color48 and the complex types /
+/////////////////////////////////////////////////////////////////////////////
+template<> void calcMinMaxChannels< uint8_t, 3>( const  uint8_t *data, size_t len,  uint8_t *min,  uint8_t *max );
+template<> void calcMinMaxChannels<uint16_t, 3>( const uint16_t *data, size_t len, uint16_t *min, uint16_t *max );
+template<> void calcMinMaxChannels<float, 2>( const float *data, size_t len, float *min, float *max );
+template<> void calcMinMaxChannels<double, 2>( const double *data, size_t len, double *min, double *max );
 #endif //__SSE2__
 
 API_EXCLUDE_BEGIN;
@@ -91,36 +136,20 @@ template<typename T> struct getMinMaxImpl<T, true> { // generic min-max for numb
 
 template<typename T> struct getMinMaxImpl<util::color<T>, false> { // generic min-max for color (get bounding box in color space)
 	std::pair<util::color<T> , util::color<T> > operator()( const ValueArray<util::color<T> > &ref ) const {
+		BOOST_STATIC_ASSERT( sizeof( util::color<T> ) == sizeof( T ) * 3 ); // we need this for the calcMinMaxChannels-hack below
+		//use color as a three element array and find the respective minmax for the three elements
 		std::pair<util::color<T> , util::color<T> > ret;
-
-		for( uint_fast8_t i = 0; i < 3; i++ ) {
-			const std::pair<T, T> buff = calcMinMax<T, 3>( &ref[0].r + i, ref.getLength() * 3 );
-			*( &ret.first.r + i ) = buff.first;
-			*( &ret.second.r + i ) = buff.second;
-		}
-
+		calcMinMaxChannels<T, 3>( &ref[0].r, ref.getLength() * 3, &ret.first.r, &ret.second.r );
 		return ret;
 	}
 };
 template<typename T> struct getMinMaxImpl<std::complex<T>, false> { // generic min-max for complex values (get bounding box in complex space)
 	std::pair<std::complex<T> , std::complex<T> > operator()( const ValueArray<std::complex<T> > &ref ) const {
-		BOOST_STATIC_ASSERT( sizeof( std::complex<T> ) == sizeof( T ) * 2 ); // we need this for the calcMinMax-hack below
+		BOOST_STATIC_ASSERT( sizeof( std::complex<T> ) == sizeof( T ) * 2 ); // we need this for the calcMinMaxChannels-hack below
 		//use complex as a two element array and find the respective minmax for the two elements
-		const std::pair<T, T > minmax[] = {
-			calcMinMax<T, 2>( reinterpret_cast<const T *>( &ref[0] ), ref.getLength() * 2 ),
-			calcMinMax<T, 2>( reinterpret_cast<const T *>( &ref[0] ) + 1, ref.getLength() * 2 )
-		};
-
-		//also use return as two element array and stuff results from above in there
-		std::pair<std::complex<T> , std::complex<T> > ret;
-		T *min = reinterpret_cast<T *>( &ret.first ), *max = reinterpret_cast<T *>( &ret.second );
-
-		for( int_fast8_t i = 0; i < 2; i++ ) {
-			min[i] = minmax[i].first;
-			max[i] = minmax[i].second;
-		}
-
-		return ret;
+		T min[2], max[2];
+		calcMinMaxChannels<T, 2>( reinterpret_cast<const T *>( &ref[0] ), ref.getLength() * 2, min, max );
+		return std::make_pair( std::complex<T>( min[0], min[1] ), std::complex<T>( max[0], max[1] ) );
 	}
 };
 /// @endcond
@@ -372,10 +401,11 @@ public:
 	}
 	//
 	scaling_pair getScalingTo( unsigned short typeID, autoscaleOption scaleopt = autoscale )const {
-		if( typeID == staticID && scaleopt == autoscale ) { // if id is the same and autoscale is requested
+		// if id is the same and autoscale is requested, or if the scaling does not depend on the data (e.g. conversion to float)
+		if( ( typeID == staticID && scaleopt == autoscale ) || !needsValueRange( typeID, scaleopt ) ) {
 			static const util::Value<uint8_t> one( 1 );
 			static const util::Value<uint8_t> zero( 0 );
-			return std::pair<util::ValueReference, util::ValueReference>( one, zero ); // the result is always 1/0
+			return std::pair<util::ValueReference, util::ValueReference>( one, zero ); // the result is always 1/0 - no need to compute min/max
 		} else { // get min/max and compute the scaling
 			std::pair<util::ValueReference, util::ValueReference> minmax = getMinMax();
 			assert( ! ( minmax.first.isEmpty() || minmax.second.isEmpty() ) );
@@ -398,6 +428,69 @@ template<typename T> bool ValueArrayBase::is()const
 }
 
 
+/// the arithmetic types out of the supported types (for visitors which can only handle numbers, see applyTyped)
+typedef boost::mpl::filter_view<util::_internal::types, boost::is_arithmetic<boost::mpl::_1> > arithmetic_types;
+
+/// @cond _internal
+namespace _internal
+{
+// calls visitor with the array cast to ValueArray<T>, if T is the type of the array
+template<typename VISITOR, typename ARRAY> struct TypedApply {
+	ARRAY &array;
+	VISITOR &visitor;
+	bool &found;
+	TypedApply( ARRAY &_array, VISITOR &_visitor, bool &_found ): array( _array ), visitor( _visitor ), found( _found ) {}
+	template<typename T> void operator()( T * ) { // for_each gives pointers, so T doesn't have to be constructed
+		if( !found && array.getTypeID() == ValueArray<T>::staticID ) {
+			found = true;
+			visitor( array.template castToValueArray<T>() );
+		}
+	}
+};
+}
+/// @endcond _internal
+
+/**
+ * Call a templated visitor with the ValueArray cast to its actual type.
+ * The type is resolved once for the whole array, so the visitor can work on the typed data directly (e.g. using begin() and end())
+ * instead of going through the GenericValueIterator and a util::ValueReference per element.
+ * \code
+ * struct Sum {
+ *  double sum;
+ *  template<typename T> void operator()( const data::ValueArray<T> &array ) {sum = std::accumulate( array.begin(), array.end(), sum );}
+ * };
+ * Sum sum = {0};
+ * data::applyTyped<data::arithmetic_types>( chunk.getValueArrayBase(), sum );
+ * \endcode
+ * \param TYPES mpl sequence of the types the visitor can handle (all supported types if not given)
+ * \param array the ValueArray to be visited
+ * \param visitor functor with a templated operator() taking a ValueArray<T>& for every T in TYPES
+ * \returns false if the type of the array is not in TYPES (visitor was not called then)
+ */
+template<typename TYPES, typename VISITOR> bool applyTyped( ValueArrayBase &array, VISITOR &visitor )
+{
+	bool found = false;
+	boost::mpl::for_each<TYPES, boost::add_pointer<boost::mpl::_1> >( _internal::TypedApply<VISITOR, ValueArrayBase>( array, visitor, found ) );
+	return found;
+}
+/// \copydoc applyTyped( ValueArrayBase &array, VISITOR &visitor )
+template<typename TYPES, typename VISITOR> bool applyTyped( const ValueArrayBase &array, VISITOR &visitor )
+{
+	bool found = false;
+	boost::mpl::for_each<TYPES, boost::add_pointer<boost::mpl::_1> >( _internal::TypedApply<VISITOR, const ValueArrayBase>( array, visitor, found ) );
+	return found;
+}
+/// Call a templated visitor with the ValueArray cast to its actual type (visitor must handle all supported types).
+template<typename VISITOR> bool applyTyped( ValueArrayBase &array, VISITOR &visitor )
+{
+	return applyTyped<util::_internal::types>( array, visitor );
+}
+/// Call a templated visitor with the ValueArray cast to its actual type (visitor must handle all supported types).
+template<typename VISITOR> bool applyTyped( const ValueArrayBase &array, VISITOR &visitor )
+{
+	return applyTyped<util::_internal::types>( array, visitor );
+}
+
 }
 }
 #endif // TYPEPTR_HPP
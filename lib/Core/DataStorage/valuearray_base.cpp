@@ -54,11 +54,9 @@ const _internal::ValueArrayConverterMap &ValueArrayBase::converters()
 
 const ValueArrayBase::Converter &ValueArrayBase::getConverterTo( unsigned short ID )const
 {
-	const _internal::ValueArrayConverterMap::const_iterator f1 = converters().find( getTypeID() );
-	LOG_IF( f1 == converters().end(), Debug, error ) << "There is no known conversion from " << util::getTypeMap()[getTypeID()];
-	const _internal::ValueArrayConverterMap::mapped_type::const_iterator f2 = f1->second.find( ID );
-	LOG_IF( f2 == f1->second.end(), Debug, error ) << "There is no known conversion from " << util::getTypeMap()[getTypeID()] << " to " << util::getTypeMap()[ID];
-	return f2->second;
+	const Converter &ret = converters().get( getTypeID(), ID );
+	LOG_IF( !ret, Debug, error ) << "There is no known conversion from " << util::getTypeMap()[getTypeID()] << " to " << util::getTypeMap()[ID];
+	return ret;
 }
 
 size_t ValueArrayBase::compare( size_t start, size_t end, const ValueArrayBase &dst, size_t dst_start ) const
@@ -130,14 +128,12 @@ bool ValueArrayBase::copyTo( isis::data::ValueArrayBase &dst, scaling_pair scali
 
 ValueArrayBase::Reference ValueArrayBase::createByID( unsigned short ID, size_t len )
 {
-	const _internal::ValueArrayConverterMap::const_iterator f1 = converters().find( ID );
-	_internal::ValueArrayConverterMap::mapped_type::const_iterator f2;
-
 	// try to get a converter to convert the requestet type into itself - they 're there for all known types
-	if( f1 != converters().end() && ( f2 = f1->second.find( ID ) ) != f1->second.end() ) {
-		const _internal::ValueArrayConverterBase &conv = *( f2->second );
+	const Converter &conv = converters().get( ID, ID );
+
+	if( conv ) {
 		boost::scoped_ptr<ValueArrayBase> ret;
-		conv.create( ret, len );
+		conv->create( ret, len );
 		return *ret;
 	} else {
 		LOG( Debug, error ) << "There is no known creator for " << util::getTypeMap()[ID];
@@ -207,6 +203,11 @@ scaling_pair ValueArrayBase::getScalingTo( unsigned short typeID, const std::pai
 		return scaling_pair();
 	}
 }
+bool ValueArrayBase::needsValueRange( unsigned short typeID, autoscaleOption scaleopt )const
+{
+	const Converter &conv = getConverterTo( typeID );
+	return !conv || conv->needsValueRange( scaleopt );
+}
 size_t ValueArrayBase::useCount() const
 {
 	return getRawAddress().use_count();
@@ -56,6 +56,11 @@ public:
 	WritingValueAdapter operator=( const util::ValueReference &val );
 };
 
+/**
+ * Iterator over the elements of a ValueArray of unknown type.
+ * Every access goes through a function pointer and creates a util::ValueReference, so this is slow.
+ * Use applyTyped (see valuearray.hpp) to run algorithms on the typed data instead.
+ */
 template<bool IS_CONST> class GenericValueIterator :
 	public std::iterator < std::random_access_iterator_tag,
 	typename boost::mpl::if_c<IS_CONST, ConstValueAdapter, WritingValueAdapter>::type,
@@ -171,7 +176,7 @@ public:
 	const_value_iterator endGeneric()const;
 
 	typedef util::_internal::GenericReference<ValueArrayBase> Reference;
-	typedef _internal::ValueArrayConverterMap::mapped_type::mapped_type Converter;
+	typedef _internal::ValueArrayConverterMap::Converter Converter;
 
 	template<typename T> bool is()const;
 
@@ -211,6 +216,13 @@ public:
 	///get the scaling (and offset) which would be used in an conversion
 	virtual scaling_pair getScalingTo( unsigned short typeID, autoscaleOption scaleopt = autoscale )const = 0;
 	virtual scaling_pair getScalingTo( unsigned short typeID, const std::pair<util::ValueReference, util::ValueReference> &minmax, autoscaleOption scaleopt = autoscale )const;
+	/**
+	 * Check if the scaling for a conversion into the given type depends on the values in this ValueArray.
+	 * If it doesn't (e.g. when converting into floating point or if noscale is requested) the scaling is always 1/0
+	 * and the conversion does not need a separate min/max-pass over the data.
+	 * \returns false if the scaling can be computed without min/max, true otherwise (also if there is no known conversion)
+	 */
+	bool needsValueRange( unsigned short typeID, autoscaleOption scaleopt = autoscale )const;
 
 	/**
 	 * Create new data in memory containg a (converted) copy of this.
@@ -27,6 +27,7 @@
 #include "numeric_convert.hpp"
 #include "../CoreUtils/types.hpp"
 #include <boost/mpl/for_each.hpp>
+#include <boost/mpl/size.hpp>
 #include <boost/type_traits/is_arithmetic.hpp>
 #include <boost/mpl/and.hpp>
 
@@ -118,6 +119,9 @@ struct NumConvImplBase {
 	static scaling_pair getScaling( const util::ValueBase &/*min*/, const util::ValueBase &/*max*/, autoscaleOption /*scaleopt*/ ) {
 		return scaling_pair( util::ValueReference( util::Value<uint8_t>( 1 ) ), util::ValueReference( util::Value<uint8_t>( 0 ) ) );
 	}
+	static bool needsValueRange( autoscaleOption /*scaleopt*/ ) {
+		return false;
+	}
 };
 // default generic conversion between numeric types
 template<typename SRC, typename DST, bool SAME> struct NumConvImpl: NumConvImplBase {
@@ -133,6 +137,9 @@ template<typename SRC, typename DST, bool SAME> struct NumConvImpl: NumConvImplB
 				   util::ValueReference( util::Value<double>( scale.second ) )
 			   );
 	}
+	static bool needsValueRange( autoscaleOption scaleopt ) {
+		return numericScalingNeedsRange<DST>( scaleopt );
+	}
 };
 // special generic conversion between equal numeric types (maybe we can copy / scaling will be 1/0)
 template<typename T> struct NumConvImpl<T, T, true>: NumConvImplBase {
@@ -195,6 +202,10 @@ scaling_pair ValueArrayConverterBase::getScaling( const isis::util::ValueBase &m
 {
 	return NumConvImplBase::getScaling( min, max, scaleopt );
 }
+bool ValueArrayConverterBase::needsValueRange( autoscaleOption scaleopt ) const
+{
+	return NumConvImplBase::needsValueRange( scaleopt );
+}
 
 //Define generator - this can be global because its using convert internally
 template<typename SRC, typename DST> class ValueArrayGenerator: public ValueArrayConverterBase
@@ -271,6 +282,9 @@ public:
 	scaling_pair getScaling( const util::ValueBase &min, const util::ValueBase &max, autoscaleOption scaleopt = autoscale )const {
 		return NumConvImpl<SRC, DST, boost::is_same<SRC, DST>::value >::getScaling( min, max, scaleopt );
 	}
+	bool needsValueRange( autoscaleOption scaleopt = autoscale )const {
+		return NumConvImpl<SRC, DST, boost::is_same<SRC, DST>::value >::needsValueRange( scaleopt );
+	}
 	virtual ~ValueArrayConverter() {}
 };
 
@@ -302,6 +316,9 @@ public:
 	scaling_pair getScaling( const util::ValueBase &min, const util::ValueBase &max, autoscaleOption scaleopt = autoscale )const {
 		return getScalingToComplex<SRC, DST>( min, max, scaleopt );
 	}
+	bool needsValueRange( autoscaleOption scaleopt = autoscale )const {
+		return numericScalingNeedsRange<DST>( scaleopt );
+	}
 	virtual ~ValueArrayConverter() {}
 };
 
@@ -345,6 +362,9 @@ public:
 	scaling_pair getScaling( const util::ValueBase &min, const util::ValueBase &max, autoscaleOption scaleopt = autoscale )const {
 		return getScalingToComplex<SRC, DST>( min, max, scaleopt );
 	}
+	bool needsValueRange( autoscaleOption scaleopt = autoscale )const {
+		return numericScalingNeedsRange<DST>( scaleopt );
+	}
 	virtual ~ValueArrayConverter() {}
 };
 
@@ -371,6 +391,9 @@ public:
 	scaling_pair getScaling( const util::ValueBase &min, const util::ValueBase &max, autoscaleOption scaleopt = autoscale )const {
 		return getScalingToColor<SRC, DST>( min, max, scaleopt );
 	}
+	bool needsValueRange( autoscaleOption scaleopt = autoscale )const {
+		return numericScalingNeedsRange<DST>( scaleopt );
+	}
 
 	virtual ~ValueArrayConverter() {}
 };
@@ -415,6 +438,9 @@ public:
 	scaling_pair getScaling( const util::ValueBase &min, const util::ValueBase &max, autoscaleOption scaleopt = autoscale )const {
 		return getScalingToColor<SRC, DST>( min, max, scaleopt );
 	}
+	bool needsValueRange( autoscaleOption scaleopt = autoscale )const {
+		return numericScalingNeedsRange<DST>( scaleopt );
+	}
 
 	virtual ~ValueArrayConverter() {}
 };
@@ -426,39 +452,52 @@ public:
 
 ///generate a ValueArrayConverter for conversions from SRC to any type from the "types" list
 template<typename SRC> struct inner_ValueArrayConverter {
-	std::map<int, boost::shared_ptr<const ValueArrayConverterBase> > &m_subMap;
-	inner_ValueArrayConverter( std::map<int, boost::shared_ptr<const ValueArrayConverterBase> > &subMap ): m_subMap( subMap ) {}
+	ValueArrayConverterMap &m_map;
+	inner_ValueArrayConverter( ValueArrayConverterMap &map ): m_map( map ) {}
 	template<typename DST> void operator()( DST ) { //will be called by the mpl::for_each in outer_ValueArrayConverter for any DST out of "types"
 		//create a converter based on the type traits and the types of SRC and DST
 		boost::shared_ptr<const ValueArrayConverterBase> conv =
 			ValueArrayConverter<boost::is_arithmetic<SRC>::value, boost::is_arithmetic<DST>::value, SRC, DST>::get();
-		//and insert it into the to-conversion-map of SRC
-		m_subMap.insert( m_subMap.end(), std::make_pair( ValueArray<DST>::staticID, conv ) );
+		//and insert it into the table
+		m_map.set( ValueArray<SRC>::staticID, ValueArray<DST>::staticID, conv );
 	}
 };
 
 ///generate a ValueArrayConverter for conversions from any SRC from the "types" list
 struct outer_ValueArrayConverter {
-	std::map< int , std::map<int, boost::shared_ptr<const ValueArrayConverterBase> > > &m_map;
-	outer_ValueArrayConverter( std::map< int , std::map<int, boost::shared_ptr<const ValueArrayConverterBase> > > &map ): m_map( map ) {}
+	ValueArrayConverterMap &m_map;
+	outer_ValueArrayConverter( ValueArrayConverterMap &map ): m_map( map ) {}
 	template<typename SRC> void operator()( SRC ) {//will be called by the mpl::for_each in ValueArrayConverterMap() for any SRC out of "types"
 		boost::mpl::for_each<util::_internal::types>( // create a functor for from-SRC-conversion and call its ()-operator for any DST out of "types"
-			inner_ValueArrayConverter<SRC>( m_map[ValueArray<SRC>::staticID] )
+			inner_ValueArrayConverter<SRC>( m_map )
 		);
 	}
 };
 
-ValueArrayConverterMap::ValueArrayConverterMap()
+// the type IDs are the positions in "types" (starting at 1) shifted by 8 bit, so the biggest index is the size of "types"
+ValueArrayConverterMap::ValueArrayConverterMap(): m_size( boost::mpl::size<util::_internal::types>::value + 1 )
 {
 #ifdef ISIS_USE_LIBOIL
 	LOG( Debug, info ) << "Initializing liboil";
 	oil_init();
 #endif // ISIS_USE_LIBOIL
+	m_table.resize( m_size * m_size );
 	boost::mpl::for_each<util::_internal::types>( outer_ValueArrayConverter( *this ) );
 	LOG( Debug, info )
 			<< "conversion map for " << size() << " array-types created";
 }
 
+void ValueArrayConverterMap::set( unsigned short src, unsigned short dst, const Converter &conv )
+{
+	assert( ( src >> 8 ) < m_size && ( dst >> 8 ) < m_size );
+	m_table[( src >> 8 ) * m_size + ( dst >> 8 )] = conv;
+}
+
+size_t ValueArrayConverterMap::size()const
+{
+	return m_size - 1;
+}
+
 }
 API_EXCLUDE_END;
 }
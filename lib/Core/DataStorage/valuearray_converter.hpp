@@ -22,7 +22,7 @@
 
 #include <boost/shared_ptr.hpp>
 #include <boost/scoped_ptr.hpp>
-#include <map>
+#include <vector>
 #include "../CoreUtils/value_base.hpp"
 
 /// @cond _internal
@@ -46,14 +46,34 @@ public:
 	/// Create a ValueArray based on the ID - if len==0 a pointer to NULL is created
 	virtual void create( boost::scoped_ptr<ValueArrayBase>& dst, size_t len )const = 0;
 	virtual scaling_pair getScaling( const util::ValueBase &min, const util::ValueBase &max, autoscaleOption scaleopt = autoscale )const;
+	/// \returns false if getScaling does not depend on min/max (so the caller does not have to compute them)
+	virtual bool needsValueRange( autoscaleOption scaleopt = autoscale )const;
 	static boost::shared_ptr<const ValueArrayConverterBase> get() {return boost::shared_ptr<const ValueArrayConverterBase>();}
 	virtual ~ValueArrayConverterBase() {}
 };
 
-class ValueArrayConverterMap : public std::map< int , std::map<int, boost::shared_ptr<const ValueArrayConverterBase> > >
+/**
+ * Table of the converters between all ValueArray types.
+ * Its dense and indexed by the IDs of source and destination type, so looking up a converter is just an array access.
+ */
+class ValueArrayConverterMap
 {
 public:
+	typedef boost::shared_ptr<const ValueArrayConverterBase> Converter;
 	ValueArrayConverterMap();
+	/// \returns the converter from the type with the ID src to the type with the ID dst (an empty pointer if there is none or the IDs are unknown)
+	const Converter &get( unsigned short src, unsigned short dst )const {
+		// the IDs of ValueArrays are the IDs of their Values shifted by 8 bit, so that is the index
+		const size_t s = src >> 8, d = dst >> 8;
+		return ( s < m_size && d < m_size ) ? m_table[s * m_size + d] : m_table[0]; // there is no type with the index 0
+	}
+	/// set the converter from the type with the ID src to the type with the ID dst
+	void set( unsigned short src, unsigned short dst, const Converter &conv );
+	/// \returns the amount of source types
+	size_t size()const;
+private:
+	std::vector<Converter> m_table; // the converter from a to b is at (a>>8)*m_size+(b>>8)
+	unsigned short m_size; // the biggest type index plus one
 };
 
 }
@@ -9,6 +9,13 @@ namespace isis
 namespace test
 {
 
+// counts how often it is written into a log message
+struct LogCounter {
+	static int written;
+};
+int LogCounter::written = 0;
+std::ostream &operator<<( std::ostream &o, const LogCounter & ) {LogCounter::written++; return o;}
+
 // TestCase object instantiation
 BOOST_AUTO_TEST_CASE( fuzzy_equal_test )
 {
@@ -31,5 +38,36 @@ BOOST_AUTO_TEST_CASE( fuzzy_equal_test )
 	BOOST_CHECK( util::fuzzyEqual( a4, b4, 1 ) ); // distance of epsilon for float is _not_ considered equal for double
 }
 
+BOOST_AUTO_TEST_CASE( log_level_gate_test )
+{
+	std::ostringstream sink;
+	util::DefaultMsgPrint::setStream( sink );
+	ENABLE_LOG( util::Runtime, util::DefaultMsgPrint, warning );
+
+	// messages above the level of the handler are dropped before their operands are written
+	LogCounter::written = 0;
+	LOG( util::Runtime, info ) << "dropped " << LogCounter();
+	LOG_IF( true, util::Runtime, notice ) << "dropped " << LogCounter();
+	BOOST_CHECK_EQUAL( LogCounter::written, 0 );
+
+	LOG( util::Runtime, warning ) << "passed " << LogCounter();
+	BOOST_CHECK_EQUAL( LogCounter::written, 1 );
+	BOOST_CHECK( sink.str().find( "passed" ) != std::string::npos );
+	BOOST_CHECK( sink.str().find( "dropped" ) == std::string::npos );
+
+	// the level is updated when the handler changes
+	ENABLE_LOG( util::Runtime, util::DefaultMsgPrint, info );
+	LOG( util::Runtime, info ) << "now passed " << LogCounter();
+	BOOST_CHECK_EQUAL( LogCounter::written, 2 );
+
+	// and no handler means no message at all
+	ENABLE_LOG( util::Runtime, util::DefaultMsgPrint, ( LogLevel )0 );
+	LOG( util::Runtime, error ) << "dropped " << LogCounter();
+	BOOST_CHECK_EQUAL( LogCounter::written, 2 );
+
+	ENABLE_LOG( util::Runtime, util::DefaultMsgPrint, notice );
+	util::DefaultMsgPrint::setStream( std::cerr );
+}
+
 }
 }
@@ -0,0 +1,160 @@
+#define BOOST_TEST_MODULE ConcurrencyTest
+#define NOMINMAX 1
+#include <boost/test/unit_test.hpp>
+#include <boost/bind.hpp>
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/barrier.hpp>
+#include <CoreUtils/common.hpp>
+#include <CoreUtils/singletons.hpp>
+#include <CoreUtils/progressfeedback.hpp>
+#include <DataStorage/io_factory.hpp>
+#include <sstream>
+
+namespace isis
+{
+namespace test
+{
+
+// counts its instances, and takes some time to be created so concurrent requests overlap
+struct SlowSingleton {
+	static boost::atomic<int> created;
+	SlowSingleton() {
+		created++;
+		boost::this_thread::sleep( boost::posix_time::milliseconds( 20 ) );
+	}
+};
+boost::atomic<int> SlowSingleton::created( 0 );
+
+void getSingleton( boost::barrier &start, SlowSingleton *&result )
+{
+	start.wait();
+	result = &util::Singletons::get<SlowSingleton, 10>();
+}
+
+BOOST_AUTO_TEST_CASE( singleton_concurrent_get_test )
+{
+	std::vector<SlowSingleton *> results( 16, NULL );
+	boost::barrier start( results.size() );
+	boost::thread_group threads;
+
+	for( size_t i = 0; i < results.size(); i++ )
+		threads.create_thread( boost::bind( getSingleton, boost::ref( start ), boost::ref( results[i] ) ) );
+
+	threads.join_all();
+
+	SlowSingleton *const single = &util::Singletons::get<SlowSingleton, 10>();
+	BOOST_CHECK_EQUAL( SlowSingleton::created, 1 );
+
+	for( size_t i = 0; i < results.size(); i++ )
+		BOOST_CHECK_EQUAL( results[i], single );
+}
+
+struct StressLog {static const char *name() {return "Stress";}; enum {use = 1};};
+
+void logMany( size_t thread )
+{
+	for( size_t i = 0; i < 2000; i++ )
+		LOG( StressLog, notice ) << "message " << i << " from thread " << thread;
+}
+void swapHandlers()
+{
+	for( size_t i = 0; i < 500; i++ ) {
+		ENABLE_LOG( StressLog, util::DefaultMsgPrint, ( i % 2 ) ? notice : ( LogLevel )0 );
+		boost::this_thread::yield();
+	}
+}
+
+BOOST_AUTO_TEST_CASE( log_handler_swap_test )
+{
+	// replacing the handler while other threads send messages must not crash or tear messages
+	std::ostringstream sink;
+	util::DefaultMsgPrint::setStream( sink );
+	boost::thread_group threads;
+
+	for( size_t t = 0; t < 4; t++ )
+		threads.create_thread( boost::bind( logMany, t ) );
+
+	threads.create_thread( swapHandlers );
+	threads.join_all();
+
+	ENABLE_LOG( StressLog, util::DefaultMsgPrint, notice );
+	util::DefaultMsgPrint::setStream( std::cerr );
+
+	// every line which was written is complete
+	std::istringstream lines( sink.str() );
+	std::string line;
+
+	while( std::getline( lines, line ) )
+		BOOST_CHECK( line.find( "Stress:notice" ) == 0 );
+}
+
+void queryFormats( boost::barrier &start, bool &same, const data::IOFactory::FileFormatList &expected_nii )
+{
+	start.wait();
+	same = true;
+
+	for( size_t i = 0; i < 200; i++ ) {
+		data::IOFactory::getFormats();
+		same &= ( data::IOFactory::getFileFormatList( "test.nii" ) == expected_nii );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( iofactory_concurrent_readers_test )
+{
+	const data::IOFactory::FileFormatList expected_nii = data::IOFactory::getFileFormatList( "test.nii" );
+	bool same[8];
+	boost::barrier start( 8 );
+	boost::thread_group threads;
+
+	for( size_t t = 0; t < 8; t++ )
+		threads.create_thread( boost::bind( queryFormats, boost::ref( start ), boost::ref( same[t] ), boost::cref( expected_nii ) ) );
+
+	threads.join_all();
+
+	for( size_t t = 0; t < 8; t++ )
+		BOOST_CHECK( same[t] );
+}
+// counts the progress it gets, and how often it gets it
+class CountingFeedback: public util::ProgressFeedback
+{
+public:
+	size_t max, count, calls;
+	CountingFeedback(): max( 0 ), count( 0 ), calls( 0 ) {}
+	void show( size_t _max, std::string ) {max = _max;}
+	size_t progress( const std::string, size_t step ) {calls++; return count += step;}
+	void close() {}
+	size_t getMax() {return max;}
+	size_t extend( size_t by ) {return max += by;}
+};
+
+void advance( util::ProgressFeedback &feedback, size_t steps )
+{
+	for( size_t i = 0; i < steps; i++ )
+		++feedback;
+}
+
+BOOST_AUTO_TEST_CASE( parallel_feedback_test )
+{
+	const boost::shared_ptr<CountingFeedback> target( new CountingFeedback );
+	{
+		util::ParallelFeedback feedback( target, 10 );
+		feedback.show( 80000, "test" );
+		BOOST_CHECK_EQUAL( target->getMax(), 80000 );
+
+		boost::thread_group threads;
+
+		for( size_t t = 0; t < 8; t++ )
+			threads.create_thread( boost::bind( advance, boost::ref( feedback ), 10000 ) );
+
+		threads.join_all();
+		feedback.close(); // passes on the remaining progress
+		BOOST_CHECK_EQUAL( feedback.progress( "", 0 ), 80000 );
+	}
+	// all progress is passed on when the feedback is gone, but in much less calls
+	BOOST_CHECK_EQUAL( target->count, 80000 );
+	BOOST_CHECK( target->calls < 1000 );
+}
+
+}
+}
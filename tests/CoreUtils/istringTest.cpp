@@ -14,6 +14,10 @@ BOOST_AUTO_TEST_CASE( istring_test )
 	BOOST_CHECK_EQUAL( util::istring( "HaLLo there" ), util::istring( "Hallo thERe" ) );
 	BOOST_CHECK( util::istring( "HaLLo there1" ) != util::istring( "Hallo thERe" ) );
 	BOOST_CHECK_EQUAL( util::istring( "Hallo thERe" ).find( "there" ), 6 );
+	BOOST_CHECK_EQUAL( util::istring( "Hallo thERe" ).find( 'E' ), 8 );
+	BOOST_CHECK_EQUAL( util::istring( "Hallo/thERe" ).find( '/' ), 5 );
+	BOOST_CHECK_EQUAL( util::istring( "Hallo thERe" ).find( '/' ), util::istring::npos );
+	BOOST_CHECK( util::istring( "abc" ) < util::istring( "ABD" ) );
 	BOOST_CHECK_EQUAL( boost::lexical_cast<util::istring>( 1234 ), "1234" );
 	BOOST_CHECK_EQUAL( boost::lexical_cast<int>( util::istring( "1234" ) ), 1234 );
 	BOOST_CHECK_EQUAL( boost::lexical_cast<util::istring>( std::string( "Test" ) ), "Test" );
@@ -0,0 +1,68 @@
+#define BOOST_TEST_MODULE LogTest
+#define NOMINMAX 1
+#include <boost/test/unit_test.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <CoreUtils/common.hpp>
+#include <sstream>
+#include <algorithm>
+
+namespace isis
+{
+namespace test
+{
+
+struct TestLog {static const char *name() {return "Test";}; enum {use = 1};};
+
+// log count different messages (the printer drops repeated messages)
+void logSome( size_t thread, size_t count )
+{
+	for( size_t i = 0; i < count; i++ )
+		LOG( TestLog, info ) << "message " << i << " from thread " << thread;
+}
+
+size_t countLines( const std::string &text )
+{
+	return std::count( text.begin(), text.end(), '\n' );
+}
+
+BOOST_AUTO_TEST_CASE( async_log_test )
+{
+	std::ostringstream sink;
+	util::DefaultMsgPrint::setStream( sink );
+	util::AsyncMsgPrint::setOverflowPolicy( util::AsyncMsgPrint::block_sender );
+	ENABLE_LOG( TestLog, util::AsyncMsgPrint, info );
+
+	// more messages than fit into the buffer, so the senders have to wait for the printer
+	boost::thread_group threads;
+
+	for( size_t t = 0; t < 4; t++ )
+		threads.create_thread( boost::bind( logSome, t, 1000 ) );
+
+	threads.join_all();
+	util::AsyncMsgPrint::flush();
+
+	// every message is there, and written as a whole
+	BOOST_CHECK_EQUAL( countLines( sink.str() ), 4000 );
+	BOOST_CHECK( sink.str().find( "Test:info" ) == 0 );
+	BOOST_CHECK( sink.str().find( "message 999 from thread 3\n" ) != std::string::npos );
+
+	// with drop_message messages may get lost, but they are counted
+	sink.str( "" );
+	util::AsyncMsgPrint::setOverflowPolicy( util::AsyncMsgPrint::drop_message );
+	const size_t dropped = util::AsyncMsgPrint::droppedMessages();
+
+	for( size_t t = 4; t < 8; t++ ) // other threads numbers so the messages are not repeated
+		threads.create_thread( boost::bind( logSome, t, 1000 ) );
+
+	threads.join_all();
+	util::AsyncMsgPrint::flush();
+	BOOST_CHECK_EQUAL( countLines( sink.str() ) + util::AsyncMsgPrint::droppedMessages() - dropped, 4000 );
+
+	util::AsyncMsgPrint::setOverflowPolicy( util::AsyncMsgPrint::block_sender );
+	ENABLE_LOG( TestLog, util::DefaultMsgPrint, notice );
+	util::DefaultMsgPrint::setStream( std::cerr );
+}
+
+}
+}
@@ -39,6 +39,17 @@ BOOST_AUTO_TEST_CASE( propMap_init_test )
 	BOOST_CHECK( map1.propertyValue( "new" ).isEmpty() );
 }
 
+BOOST_AUTO_TEST_CASE( propMap_path_test )
+{
+	BOOST_CHECK( util::PropertyMap::PropPath( "" ).empty() );
+	BOOST_CHECK_EQUAL( util::PropertyMap::PropPath( "Test1" ).size(), 1 );
+	BOOST_CHECK_EQUAL( util::PropertyMap::PropPath( "Test1" ).front(), "test1" );
+	BOOST_CHECK_EQUAL( util::PropertyMap::PropPath( "sub/Test1" ).size(), 2 );
+	BOOST_CHECK_EQUAL( util::PropertyMap::PropPath( "/sub//Test1/" ).size(), 2 );
+	BOOST_CHECK_EQUAL( util::PropertyMap::PropPath( "/sub//Test1/" ).back(), "Test1" );
+	BOOST_CHECK_EQUAL( util::PropertyMap::PropPath( util::istring( "sub/sub/Test1" ) ).size(), 3 );
+}
+
 BOOST_AUTO_TEST_CASE( propMap_set_test )
 {
 	util::PropertyMap map1;
@@ -179,5 +190,41 @@ BOOST_AUTO_TEST_CASE( propMap_find_test )
 	BOOST_CHECK_EQUAL( map.find( "sub1" ), "sub1/sub1" );
 	BOOST_CHECK_EQUAL( map.find( "sub1", false, true ), "sub1" ); // this is the branch "sub1"
 }
+
+BOOST_AUTO_TEST_CASE( propMap_cow_test )
+{
+	util::PropertyMap map;
+	map.propertyValue( "Test1" ) = 6.4;
+	map.propertyValue( "sub/Test1" ) = ( int32_t )1;
+	map.propertyValue( "sub/sub/Test2" ) = ( int32_t )2;
+
+	// copies share their branches
+	util::PropertyMap copy = map;
+	const util::PropertyMap &cmap = map, &ccopy = copy;
+	BOOST_CHECK_EQUAL( &cmap.branch( "sub" ), &ccopy.branch( "sub" ) );
+	BOOST_CHECK( copy.getDifference( map ).empty() );
+
+	// until one of them is changed
+	copy.propertyValue( "sub/sub/Test2" ) = ( int32_t )3;
+	BOOST_CHECK( &cmap.branch( "sub" ) != &ccopy.branch( "sub" ) );
+	BOOST_CHECK_EQUAL( map.propertyValue( "sub/sub/Test2" ), ( int32_t )2 );
+	BOOST_CHECK_EQUAL( copy.propertyValue( "sub/sub/Test2" ), ( int32_t )3 );
+	BOOST_CHECK_EQUAL( copy.getDifference( map ).size(), 1 );
+	BOOST_CHECK_EQUAL( copy.getDifference( map ).begin()->first, "sub/sub/Test2" );
+
+	// removing a shared branch removes all of it, the other map stays untouched
+	util::PropertyMap copy2 = map;
+	copy2.propertyValue( "Test2" ) = ( int32_t )5;
+	BOOST_CHECK( copy2.remove( map ) );
+	BOOST_CHECK_EQUAL( copy2.getKeys().size(), 1 );
+	BOOST_CHECK( copy2.hasProperty( "Test2" ) );
+	BOOST_CHECK_EQUAL( map.getKeys().size(), 3 );
+
+	// joining shares branches as well
+	util::PropertyMap joined;
+	BOOST_CHECK( joined.join( map ).empty() );
+	BOOST_CHECK_EQUAL( &static_cast<const util::PropertyMap &>( joined ).branch( "sub" ), &cmap.branch( "sub" ) );
+	BOOST_CHECK( joined.join( copy ).size() == 1 ); // sub/sub/Test2 differs
+}
 }
 }
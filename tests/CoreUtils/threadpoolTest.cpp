@@ -0,0 +1,137 @@
+#define BOOST_TEST_MODULE ThreadPoolTest
+#define NOMINMAX 1
+#include <boost/test/unit_test.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+#include <CoreUtils/threadpool.hpp>
+#include <vector>
+#include <stdexcept>
+
+namespace isis
+{
+namespace test
+{
+
+void square( std::vector<size_t> &vec, size_t at )
+{
+	vec[at] = at * at;
+}
+void count( size_t &cnt, boost::mutex &mutex )
+{
+	const boost::lock_guard<boost::mutex> lock( mutex );
+	cnt++;
+}
+void squareAll( util::ThreadPool &pool, std::vector<std::vector<size_t> > &vecs, size_t at )
+{
+	pool.parallelFor( vecs[at].size(), boost::bind( square, boost::ref( vecs[at] ), _1 ) );
+}
+
+void throwSomething()
+{
+	throw 42; // not derived from std::exception
+}
+void throwAt( size_t at, size_t &cnt, boost::mutex &mutex )
+{
+	count( cnt, mutex );
+
+	if( at % 10 == 3 )
+		throw std::runtime_error( "job failed" );
+}
+
+BOOST_AUTO_TEST_CASE( threadpool_run_test )
+{
+	std::vector<size_t> result( 1000 );
+	util::ThreadPool pool( 4 );
+	BOOST_CHECK_EQUAL( pool.threads(), 4 );
+
+	for( size_t i = 0; i < result.size(); i++ )
+		pool.post( boost::bind( square, boost::ref( result ), i ) );
+
+	pool.wait();
+
+	for( size_t i = 0; i < result.size(); i++ )
+		BOOST_REQUIRE_EQUAL( result[i], i * i );
+}
+
+BOOST_AUTO_TEST_CASE( threadpool_reuse_test )
+{
+	size_t cnt = 0;
+	boost::mutex mutex;
+	util::ThreadPool pool;
+	BOOST_CHECK( pool.threads() > 0 );
+
+	for( size_t batch = 1; batch <= 10; batch++ ) {
+		for( size_t i = 0; i < 100; i++ )
+			pool.post( boost::bind( count, boost::ref( cnt ), boost::ref( mutex ) ) );
+
+		pool.wait();
+		BOOST_REQUIRE_EQUAL( cnt, batch * 100 );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( threadpool_parallel_for_test )
+{
+	util::ThreadPool pool( 2 );
+	std::vector<size_t> result( 1000 );
+	pool.parallelFor( result.size(), boost::bind( square, boost::ref( result ), _1 ) );
+
+	for( size_t i = 0; i < result.size(); i++ )
+		BOOST_REQUIRE_EQUAL( result[i], i * i );
+
+	// nested use from within the pool must not deadlock, even if there are more outer jobs than workers
+	std::vector<std::vector<size_t> > results( 8, std::vector<size_t>( 100 ) );
+	pool.parallelFor( results.size(), boost::bind( squareAll, boost::ref( pool ), boost::ref( results ), _1 ) );
+
+	for( size_t j = 0; j < results.size(); j++ )
+		for( size_t i = 0; i < results[j].size(); i++ )
+			BOOST_REQUIRE_EQUAL( results[j][i], i * i );
+}
+
+BOOST_AUTO_TEST_CASE( threadpool_destruct_test )
+{
+	size_t cnt = 0;
+	boost::mutex mutex;
+	{
+		util::ThreadPool pool( 2 );
+
+		for( size_t i = 0; i < 100; i++ )
+			pool.post( boost::bind( count, boost::ref( cnt ), boost::ref( mutex ) ) );
+	}// destructor must finish all pending tasks
+	BOOST_CHECK_EQUAL( cnt, 100 );
+}
+BOOST_AUTO_TEST_CASE( threadpool_exception_test )
+{
+	size_t cnt = 0;
+	boost::mutex mutex;
+	util::ThreadPool pool( 2 );
+
+	// tasks throwing anything must not kill the workers or keep wait from returning
+	for( size_t i = 0; i < 10; i++ )
+		pool.post( throwSomething );
+
+	pool.wait();
+
+	for( size_t i = 0; i < 10; i++ )
+		pool.post( boost::bind( count, boost::ref( cnt ), boost::ref( mutex ) ) );
+
+	pool.wait();
+	BOOST_CHECK_EQUAL( cnt, 10 );
+}
+BOOST_AUTO_TEST_CASE( threadpool_parallel_for_exception_test )
+{
+	size_t cnt = 0;
+	boost::mutex mutex;
+	util::ThreadPool pool( 2 );
+
+	// all jobs are run, and the exception is rethrown in the caller
+	BOOST_CHECK_THROW( pool.parallelFor( 100, boost::bind( throwAt, _1, boost::ref( cnt ), boost::ref( mutex ) ) ), std::runtime_error );
+	BOOST_CHECK_EQUAL( cnt, 100 );
+
+	// the pool is still usable
+	std::vector<size_t> result( 100 );
+	pool.parallelFor( result.size(), boost::bind( square, boost::ref( result ), _1 ) );
+	BOOST_CHECK_EQUAL( result[99], 99 * 99 );
+}
+
+}
+}
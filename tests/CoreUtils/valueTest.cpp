@@ -160,6 +160,17 @@ BOOST_AUTO_TEST_CASE( type_conversion_test )
 	BOOST_CHECK_EQUAL( fRef2->as<int32_t>(), ( int32_t )ceil( tFloat2 - .5 ) );
 	BOOST_CHECK_EQUAL( fRef2->as<std::string>(), "3.5415" );
 	BOOST_CHECK_EQUAL( vRef->as<fvector4>(), fvector4( 1, 2, 3, 4 ) );
+
+	// as gives the same as copyByID, even if the conversion fails
+	const Value<int32_t> big( 300 ), negative( -5 );
+	const Value<std::string> text( "no number" );
+	BOOST_CHECK_EQUAL( big.as<uint8_t>(), big.copyByID( Value<uint8_t>::staticID )->castTo<uint8_t>() );
+	BOOST_CHECK_EQUAL( negative.as<uint16_t>(), negative.copyByID( Value<uint16_t>::staticID )->castTo<uint16_t>() );
+	BOOST_CHECK_EQUAL( text.as<int32_t>(), text.copyByID( Value<int32_t>::staticID )->castTo<int32_t>() );
+
+	// converters are found by the IDs of both types
+	BOOST_CHECK( tInt.getConverterTo( Value<double>::staticID ) );
+	BOOST_CHECK( vec.getConverterTo( Value<std::string>::staticID ) );
 }
 
 BOOST_AUTO_TEST_CASE( complex_conversion_test )
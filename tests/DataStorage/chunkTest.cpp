@@ -96,6 +96,99 @@ BOOST_AUTO_TEST_CASE ( chunk_foreach_voxel_test )
 	BOOST_CHECK_EQUAL( ch.foreachVoxel( check ), 0 ); // now they all should be
 }
 
+// functors for chunk_foreach_callable_test (local classes cannot be used as template arguments)
+struct SetIdx {
+	data::_internal::NDimensional<4> geometry;
+	size_t calls;
+	SetIdx( const data::_internal::NDimensional<4> &geo ): geometry( geo ), calls( 0 ) {}
+	bool operator()( uint16_t &vox, const util::vector4<size_t> &pos ) {
+		vox = geometry.getLinearIndex( &pos[0] );
+		calls++;
+		return vox != 5;
+	}
+};
+struct Threshold {
+	uint16_t threshold;
+	size_t cut;
+	Threshold( uint16_t _threshold ): threshold( _threshold ), cut( 0 ) {}
+	void operator()( uint16_t &vox ) {
+		if( vox > threshold ) {
+			vox = threshold;
+			cut++;
+		}
+	}
+};
+
+BOOST_AUTO_TEST_CASE ( chunk_foreach_callable_test )
+{
+	data::MemChunk<uint16_t> ch( 4, 3, 2, 2 );
+
+	SetIdx set( ch );
+	BOOST_CHECK_EQUAL( ch.foreachVoxel<uint16_t>( set ), 1 ); // voxel 5 "fails"
+	BOOST_CHECK_EQUAL( set.calls, ch.getVolume() );
+
+	for( size_t i = 0; i < ch.getVolume(); i++ )
+		BOOST_REQUIRE_EQUAL( ch.asValueArray<uint16_t>()[i], i );
+
+	// the offset is added to the position
+	SetIdx set_offset( data::MemChunk<uint16_t>( 5, 3, 2, 2 ) );
+	BOOST_CHECK_EQUAL( ch.foreachVoxel<uint16_t>( set_offset, util::vector4<size_t>( 1, 0, 0, 0 ) ), 0 );
+	BOOST_CHECK_EQUAL( ch.voxel<uint16_t>( 0, 0 ), 1 );
+	BOOST_CHECK_EQUAL( ch.voxel<uint16_t>( 0, 1 ), 6 );
+
+	size_t above = 0;
+
+	for( size_t i = 0; i < ch.getVolume(); i++ )
+		if( ch.asValueArray<uint16_t>()[i] > 10 )
+			above++;
+
+	const Threshold cut = ch.foreachValue<uint16_t>( Threshold( 10 ) );
+	BOOST_CHECK_EQUAL( cut.cut, above );
+
+	for( size_t i = 0; i < ch.getVolume(); i++ )
+		BOOST_REQUIRE( ch.asValueArray<uint16_t>()[i] <= 10 );
+}
+
+BOOST_AUTO_TEST_CASE ( chunk_parallel_foreach_voxel_test )
+{
+	data::MemChunk<uint32_t> ch( 300, 200, 3, 2 ); // big enough to be split into multiple blocks
+
+	class setIdx: public data::ParallelVoxelOp<uint32_t>
+	{
+		data::_internal::NDimensional<4> chunkGeometry;
+	public:
+		uint64_t sum;
+		size_t clones;
+		setIdx( data::_internal::NDimensional<4> geo ): chunkGeometry( geo ), sum( 0 ), clones( 0 ) {}
+		bool operator()( uint32_t &vox, const util::vector4<size_t>& pos ) {
+			vox = chunkGeometry.getLinearIndex( &pos[0] );
+			sum += vox;
+			return vox % 2 == 0; // let every odd voxel "fail"
+		}
+		setIdx *clone()const {return new setIdx( chunkGeometry );}
+		void join( ParallelVoxelOp<uint32_t> &clone ) {
+			sum += static_cast<setIdx &>( clone ).sum;
+			clones++;
+		}
+	};
+
+	setIdx set( ch );
+	BOOST_CHECK_EQUAL( ch.foreachVoxel( set, data::parallel_execution ), ch.getVolume() / 2 );
+	BOOST_CHECK_EQUAL( set.sum, ( uint64_t )ch.getVolume() * ( ch.getVolume() - 1 ) / 2 );
+	BOOST_CHECK( set.clones >= 1 );
+
+	// sequential execution (the default) uses the op itself
+	setIdx seq( ch );
+	BOOST_CHECK_EQUAL( ch.foreachVoxel( seq ), ch.getVolume() / 2 );
+	BOOST_CHECK_EQUAL( seq.sum, set.sum );
+	BOOST_CHECK_EQUAL( seq.clones, 0 );
+
+	const data::ValueArray<uint32_t> &data = ch.asValueArray<uint32_t>();
+
+	for( size_t i = 0; i < ch.getVolume(); i++ )
+		BOOST_REQUIRE_EQUAL( data[i], i );
+}
+
 BOOST_AUTO_TEST_CASE ( chunk_mem_init_test )
 {
 	const short data[3 * 3] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
@@ -50,5 +50,61 @@ BOOST_AUTO_TEST_CASE ( imageList_chunk_test )
 	}
 }
 
+data::MemChunk<float> genChunk( size_t size, uint32_t acq, uint16_t sequence, float value )
+{
+	data::MemChunk<float> ch( size, size, size );
+	ch.setPropertyAs( "indexOrigin", util::fvector3() );
+	ch.setPropertyAs( "acquisitionNumber", acq );
+	ch.setPropertyAs( "rowVec", util::fvector3( 1, 0 ) );
+	ch.setPropertyAs( "columnVec", util::fvector3( 0, 1 ) );
+	ch.setPropertyAs( "voxelSize", util::fvector3( 1, 1, 1 ) );
+	ch.setPropertyAs( "sequenceNumber", sequence );
+	ch.voxel<float>( 0, 0, 0 ) = value;
+	return ch;
+}
+
+/* images from mixed chunks are created in the order of their first chunk */
+BOOST_AUTO_TEST_CASE ( imageList_order_test )
+{
+	std::list<data::Chunk> chunks;
+	chunks.push_back( genChunk( 3, 0, 2, 1 ) );
+	chunks.push_back( genChunk( 3, 0, 0, 2 ) );
+	chunks.push_back( genChunk( 4, 0, 2, 3 ) ); // same series but different size
+	chunks.push_back( genChunk( 3, 1, 2, 1 ) );
+	chunks.push_back( genChunk( 3, 1, 0, 2 ) );
+	chunks.push_back( genChunk( 3, 1, 0, 4 ) ); // same position and acquisitionNumber as the chunk before - must go into another image
+	chunks.push_back( genChunk( 3, 0, 0, 4 ) );
+
+	std::list<data::Image> list = data::IOFactory::chunkListToImageList( chunks );
+	BOOST_CHECK( chunks.empty() );
+	BOOST_REQUIRE_EQUAL( list.size(), 4 );
+
+	const float values[] = {1, 2, 3, 4};
+	const size_t timesteps[] = {2, 2, 1, 2};
+	size_t cnt = 0;
+	BOOST_FOREACH( data::Image & ref, list ) {
+		BOOST_CHECK_EQUAL( ref.getDimSize( data::timeDim ), timesteps[cnt] );
+
+		for ( size_t t = 0; t < timesteps[cnt]; t++ )
+			BOOST_CHECK_EQUAL( ref.voxel<float>( 0, 0, 0, t ), values[cnt] );
+
+		cnt++;
+	}
+}
+
+/* -0 and 0 are equal as properties, so they must not split an image */
+BOOST_AUTO_TEST_CASE ( imageList_negative_zero_test )
+{
+	std::list<data::Chunk> chunks;
+	chunks.push_back( genChunk( 3, 0, 0, 1 ) );
+	chunks.push_back( genChunk( 3, 1, 0, 2 ) );
+	chunks.back().setPropertyAs( "rowVec", util::fvector3( 1, -0.f, -0.f ) );
+	chunks.back().setPropertyAs( "columnVec", util::fvector3( -0.f, 1, -0.f ) );
+
+	std::list<data::Image> list = data::IOFactory::chunkListToImageList( chunks );
+	BOOST_REQUIRE_EQUAL( list.size(), 1 );
+	BOOST_CHECK_EQUAL( list.front().getDimSize( data::timeDim ), 2 );
+}
+
 }
 }
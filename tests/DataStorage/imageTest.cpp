@@ -189,6 +189,141 @@ BOOST_AUTO_TEST_CASE ( copy_image_test )
 
 	data::Image copy = img.copyByID();
 	BOOST_CHECK( img.compare( copy ) == 0 );
+
+	// the copy must be deep
+	copy.voxel<float>( 0, 0, 0, 0 ) = 42;
+	BOOST_CHECK_EQUAL( img.voxel<float>( 0, 0, 0, 0 ), 0 );
+	BOOST_CHECK_EQUAL( img.compare( copy ), 1 );
+
+	data::Image parallel = img.copyByID( data::ValueArray<int16_t>::staticID, data::scaling_pair(), data::parallel_execution );
+	BOOST_CHECK( parallel.copyChunksToVector( false ).front().is<int16_t>() );
+	BOOST_CHECK( parallel.copyChunksToVector( false ).back().is<int16_t>() );
+}
+
+BOOST_AUTO_TEST_CASE ( parallel_convert_image_test )
+{
+	std::list<data::Chunk> chunks;
+
+	for( size_t i = 0; i < 20; i++ ) {
+		chunks.push_back( genSlice<int16_t>( 4, 4, i ) );
+		chunks.back().voxel<int16_t>( 1, 1 ) = i * 100;
+	}
+
+	chunks.back().voxel<int16_t>( 0, 0 ) = -50;
+
+	data::Image seq( chunks ), par( seq.copyByID() );
+	BOOST_REQUIRE( seq.isClean() && par.isClean() );
+
+	BOOST_REQUIRE( seq.convertToType( data::ValueArray<uint8_t>::staticID, data::autoscale, data::sequential_execution ) );
+	BOOST_REQUIRE( par.convertToType( data::ValueArray<uint8_t>::staticID, data::autoscale, data::parallel_execution ) );
+	BOOST_CHECK_EQUAL( seq.compare( par ), 0 );
+
+	for( size_t i = 0; i < 20; i++ )
+		BOOST_REQUIRE( par.getChunk( 0, 0, i ).is<uint8_t>() );
+
+	// TypedImage follows the default policy
+	data::setExecutionPolicy( data::parallel_execution );
+	const data::TypedImage<float> typed( seq.copyByID() );
+	data::setExecutionPolicy( data::sequential_execution );
+	BOOST_CHECK_EQUAL( typed.voxel<float>( 1, 1, 19 ), seq.voxel<uint8_t>( 1, 1, 19 ) );
+}
+
+BOOST_AUTO_TEST_CASE ( bulk_image_test )
+{
+	std::vector<data::Chunk> chunks;
+
+	for ( int t = 3; t >= 0; t-- ) // put them in in a mixed order
+		for ( int z = 0; z < 5; z++ ) {
+			chunks.push_back( genSlice<float>( 4, 4, ( z * 3 ) % 5, t ) );
+			chunks.back().voxel<float>( 0, 0 ) = t * 5 + ( z * 3 ) % 5;
+		}
+
+	chunks.push_back( genSlice<float>( 4, 4, 2, 1 ) ); // duplicate - will be rejected
+	chunks.back().voxel<float>( 0, 0 ) = -1;
+	chunks.push_back( genSlice<float>( 3, 3, 2, 5 ) ); // wrong size - will be rejected
+
+	std::list<data::Chunk> chunk_list( chunks.begin(), chunks.end() );
+	const data::Image list_img( chunk_list );
+	const data::Image img( chunks );
+
+	BOOST_REQUIRE( img.isClean() );
+	BOOST_REQUIRE( img.isValid() );
+	BOOST_CHECK_EQUAL( img.getSizeAsVector(), util::vector4<size_t>( 4, 4, 5, 4 ) );
+	BOOST_CHECK_EQUAL( img.getSizeAsVector(), list_img.getSizeAsVector() );
+
+	for ( size_t t = 0; t < 4; t++ )
+		for ( size_t z = 0; z < 5; z++ ) {
+			BOOST_CHECK_EQUAL( img.voxel<float>( 0, 0, z, t ), t * 5 + z );
+			BOOST_CHECK_EQUAL( list_img.voxel<float>( 0, 0, z, t ), t * 5 + z );
+		}
+
+	// the rejected chunks stay in the vector
+	BOOST_REQUIRE_EQUAL( chunks.size(), 2 );
+	BOOST_CHECK_EQUAL( chunks[0].voxel<float>( 0, 0 ), -1 );
+	BOOST_CHECK_EQUAL( chunks[1].getSizeAsVector(), util::vector4<size_t>( 3, 3, 1, 1 ) );
+	BOOST_CHECK_EQUAL( chunk_list.size(), 2 );
+}
+
+data::Chunk genVolume( uint32_t acnum, float value )
+{
+	data::MemChunk<float> ch( 4, 4, 3 );
+	ch.setPropertyAs( "indexOrigin", util::fvector3( 0, 0, 0 ) );
+	ch.setPropertyAs( "rowVec", util::fvector3( 1, 0 ) );
+	ch.setPropertyAs( "columnVec", util::fvector3( 0, 1 ) );
+	ch.setPropertyAs( "sliceVec", util::fvector3( 0, 0, 1 ) );
+	ch.setPropertyAs( "voxelSize", util::fvector3( 1, 1, 1 ) );
+	ch.setPropertyAs( "sequenceNumber", ( uint16_t )0 );
+	ch.setPropertyAs( "acquisitionNumber", acnum );
+	ch.setPropertyAs( "acquisitionTime", acnum * 2.5f );
+	ch.voxel<float>( 1, 2, 1 ) = value;
+	return ch;
+}
+
+BOOST_AUTO_TEST_CASE ( append_timestep_test )
+{
+	std::list<data::Chunk> chunks( 1, genVolume( 0, 0 ) );
+	std::list<data::Chunk> first = chunks;
+	data::Image img( first );
+	BOOST_REQUIRE( img.isClean() );
+	BOOST_REQUIRE_EQUAL( img.getNrOfTimesteps(), 1 );
+
+	for ( uint32_t t = 1; t < 10; t++ ) {
+		chunks.push_back( genVolume( t, t ) );
+		BOOST_REQUIRE( img.appendTimestep( chunks.back() ) );
+		BOOST_CHECK( img.isClean() );
+	}
+
+	// chunks which do not fit are rejected and do not change the image
+	data::Chunk moved = genVolume( 20, -1 );
+	moved.setPropertyAs( "indexOrigin", util::fvector3( 0, 0, 5 ) );
+	data::Chunk other_seq = genVolume( 20, -1 );
+	other_seq.setPropertyAs( "sequenceNumber", ( uint16_t )1 );
+
+	BOOST_CHECK( !img.appendTimestep( genVolume( 5, -1 ) ) ); // already there
+	BOOST_CHECK( !img.appendTimestep( genVolume( 3, -1 ) ) ); // not at the end
+	BOOST_CHECK( !img.appendTimestep( moved ) );
+	BOOST_CHECK( !img.appendTimestep( other_seq ) );
+	BOOST_CHECK( !img.appendTimestep( data::MemChunk<float>( 4, 4, 3 ) ) ); // invalid
+
+	// the result is the same as building the image from all chunks
+	const data::Image list_img( chunks );
+	BOOST_REQUIRE( img.isClean() );
+	BOOST_REQUIRE( img.isValid() );
+	BOOST_CHECK_EQUAL( img.getSizeAsVector(), util::vector4<size_t>( 4, 4, 3, 10 ) );
+	BOOST_CHECK_EQUAL( img.getSizeAsVector(), list_img.getSizeAsVector() );
+	BOOST_CHECK_EQUAL( img.compare( list_img ), 0 );
+
+	for ( uint32_t t = 0; t < 10; t++ ) {
+		BOOST_CHECK_EQUAL( img.voxel<float>( 1, 2, 1, t ), t );
+		const data::Chunk ch = img.getChunk( 0, 0, 0, t );
+		BOOST_CHECK_EQUAL( ch.getPropertyAs<uint32_t>( "acquisitionNumber" ), t );
+		BOOST_CHECK_EQUAL( ch.getPropertyAs<float>( "acquisitionTime" ), t * 2.5f );
+	}
+
+	// common properties stay in the image
+	BOOST_CHECK( !img.hasProperty( "acquisitionNumber" ) );
+	BOOST_CHECK( !img.getChunkAt( 9, false ).hasProperty( "sequenceNumber" ) );
+	BOOST_CHECK_EQUAL( img.getPropertyAs<uint16_t>( "sequenceNumber" ), 0 );
 }
 
 BOOST_AUTO_TEST_CASE ( copyChunksToVector_test )
@@ -321,6 +456,19 @@ BOOST_AUTO_TEST_CASE ( type_scale_test )
 	data::scaling_pair scale = img.getScalingTo( data::ValueArray<uint8_t>::staticID );
 	BOOST_CHECK_EQUAL( scale.first->as<double>(), 1. / 10 );
 	BOOST_CHECK_EQUAL( scale.second->as<double>(), 5 );
+
+	// conversion into float does not scale
+	scale = img.getScalingTo( data::ValueArray<float>::staticID );
+	BOOST_CHECK_EQUAL( scale.first->as<double>(), 1 );
+	BOOST_CHECK_EQUAL( scale.second->as<double>(), 0 );
+
+	// all chunks must be converted with the same scaling
+	BOOST_REQUIRE( img.convertToType( data::ValueArray<uint8_t>::staticID ) );
+	BOOST_CHECK_EQUAL( img.voxel<uint8_t>( 0, 0, 0 ), 0 );
+	BOOST_CHECK_EQUAL( img.voxel<uint8_t>( 0, 0, 1 ), 5 );
+	BOOST_CHECK_EQUAL( img.voxel<uint8_t>( 0, 0, 2 ), 5 );
+	BOOST_CHECK_EQUAL( img.voxel<uint8_t>( 0, 0, 3 ), 255 );
+	BOOST_CHECK_EQUAL( img.voxel<uint8_t>( 1, 0, 3 ), 5 );
 }
 
 BOOST_AUTO_TEST_CASE ( image_chunk_test )
@@ -436,6 +584,126 @@ BOOST_AUTO_TEST_CASE ( image_foreach_chunk_test )
 
 }
 
+// functors for image_foreach_callable_test (local classes cannot be used as template arguments)
+struct CheckIdx {
+	data::_internal::NDimensional<4> geometry;
+	CheckIdx( const data::_internal::NDimensional<4> &geo ): geometry( geo ) {}
+	bool operator()( const float &vox, const util::vector4<size_t> &pos )const {
+		return vox == geometry.getLinearIndex( &pos[0] );
+	}
+};
+struct Sum {
+	double sum;
+	Sum(): sum( 0 ) {}
+	void operator()( float &vox ) {sum += vox;}
+};
+
+BOOST_AUTO_TEST_CASE ( image_foreach_callable_test )
+{
+	std::list<data::Chunk> chunks;
+
+	for ( int i = 0; i < 3; i++ )
+		chunks.push_back( genSlice<float>( 4, 3, i, i ) );
+
+	data::Image img( chunks );
+	const size_t volume = img.getVolume();
+
+	for( size_t i = 0; i < volume; i++ ) {
+		size_t pos[4];
+		img.getCoordsFromLinIndex( i, pos );
+		img.voxel<float>( pos[data::rowDim], pos[data::columnDim], pos[data::sliceDim] ) = i;
+	}
+
+	CheckIdx check( img );
+	BOOST_CHECK_EQUAL( img.foreachVoxel<float>( check ), 0 );
+	BOOST_CHECK_EQUAL( img.foreachValue<float>( Sum() ).sum, volume * ( volume - 1 ) / 2 );
+}
+
+BOOST_AUTO_TEST_CASE ( image_parallel_foreach_test )
+{
+	std::list<data::Chunk> chunks;
+
+	for ( int i = 0; i < 4; i++ )
+		chunks.push_back( genSlice<uint8_t>( 200, 100, i, i ) );
+
+	data::Image img( chunks );
+
+	class countChunks: public data::ParallelChunkOp
+	{
+	public:
+		size_t chunks, voxels;
+		countChunks(): chunks( 0 ), voxels( 0 ) {}
+		bool operator()( data::Chunk &ch, util::vector4<size_t> posInImage ) {
+			chunks++;
+			voxels += ch.getVolume();
+			return posInImage[data::sliceDim] != 2;
+		}
+		countChunks *clone()const {return new countChunks;}
+		void join( ParallelChunkOp &clone ) {
+			chunks += static_cast<countChunks &>( clone ).chunks;
+			voxels += static_cast<countChunks &>( clone ).voxels;
+		}
+	} count;
+
+	BOOST_CHECK_EQUAL( img.foreachChunk( count, false, data::parallel_execution ), 1 );
+	BOOST_CHECK_EQUAL( count.chunks, 4 );
+	BOOST_CHECK_EQUAL( count.voxels, img.getVolume() );
+
+	// sequential execution (the default) uses the op itself
+	BOOST_CHECK_EQUAL( img.foreachChunk( count ), 1 );
+	BOOST_CHECK_EQUAL( count.chunks, 8 );
+
+	class setIdx: public data::ParallelVoxelOp<uint16_t>
+	{
+		data::_internal::NDimensional<4> geometry;
+	public:
+		uint64_t sum;
+		setIdx( data::_internal::NDimensional<4> geo ): geometry( geo ), sum( 0 ) {}
+		bool operator()( uint16_t &vox, const util::vector4<size_t>& pos ) {
+			vox = geometry.getLinearIndex( &pos[0] ) % 60000;
+			sum += vox;
+			return true;
+		}
+		setIdx *clone()const {return new setIdx( geometry );}
+		void join( ParallelVoxelOp<uint16_t> &clone ) {
+			sum += static_cast<setIdx &>( clone ).sum;
+		}
+	} setidx( img );
+
+	// this will convert the image to uint16_t
+	BOOST_REQUIRE_EQUAL( img.foreachVoxel<uint16_t>( setidx, data::parallel_execution ), 0 );
+	BOOST_CHECK( img.getMajorTypeID() == data::ValueArray<uint16_t>::staticID );
+
+	uint64_t sum = 0;
+	size_t cnt = 0;
+	const util::vector4<size_t> imgSize = img.getSizeAsVector();
+
+	for( size_t z = 0; z < imgSize[data::sliceDim]; z++ )
+		for( size_t y = 0; y < imgSize[data::columnDim]; y++ )
+			for( size_t x = 0; x < imgSize[data::rowDim]; x++, cnt++ ) {
+				BOOST_REQUIRE_EQUAL( img.voxel<uint16_t>( x, y, z ), cnt % 60000 );
+				sum += cnt % 60000;
+			}
+
+	BOOST_CHECK_EQUAL( setidx.sum, sum );
+
+	// exceptions thrown by the clones are rethrown in the caller
+	class failAt: public data::ParallelVoxelOp<uint16_t>
+	{
+	public:
+		bool operator()( uint16_t &/*vox*/, const util::vector4<size_t>& pos ) {
+			if( pos[data::sliceDim] == 3 && pos[data::columnDim] == 50 )
+				throw std::runtime_error( "voxel failed" );
+
+			return true;
+		}
+		failAt *clone()const {return new failAt;}
+	} fail;
+
+	BOOST_CHECK_THROW( img.foreachVoxel<uint16_t>( fail, data::parallel_execution ), std::runtime_error );
+	BOOST_CHECK_THROW( img.foreachVoxel<uint16_t>( fail, data::sequential_execution ), std::runtime_error );
+}
+
 BOOST_AUTO_TEST_CASE ( image_voxel_test )
 {
 	//  get a voxel from inside and outside the image
@@ -639,6 +907,114 @@ BOOST_AUTO_TEST_CASE ( typed_image_iterator_test )
 	BOOST_CHECK_EQUAL( std::distance( start, i ), img.getLinearIndex( util::vector4<size_t>( 1, 1, 1 ) ) ); //we should be exactly at the position of the second 42 now
 }
 
+BOOST_AUTO_TEST_CASE ( typed_image_increment_test )
+{
+	std::list<data::Chunk> chunks;
+
+	for( int i = 0; i < 3; i++ )
+		chunks.push_back( genSlice<float>( 3, 3, i, i ) );
+
+	data::TypedImage<float> img = data::Image( chunks );
+	float cnt = 0;
+
+	for( data::TypedImage<float>::iterator i = img.begin(); i != img.end(); i++ )
+		*i = cnt++;
+
+	BOOST_CHECK_EQUAL( cnt, img.getVolume() ); // ++ must reach end() after exactly getVolume() steps
+
+	for( size_t i = 0; i < img.getVolume(); i++ )
+		BOOST_REQUIRE_EQUAL( img.begin()[i], i );
+}
+
+struct Double {
+	float operator()( float val )const {return val * 2;}
+};
+BOOST_AUTO_TEST_CASE ( image_segments_test )
+{
+	std::list<data::Chunk> chunks;
+
+	for( int i = 0; i < 3; i++ )
+		chunks.push_back( genSlice<float>( 3, 3, i, i ) );
+
+	data::Image img( chunks );
+	const size_t volume = img.getVolume();
+
+	// the wrong type gives no segments
+	BOOST_CHECK( img.getSegments<int16_t>().empty() );
+
+	const std::vector<data::Segment<float> > segments = img.getSegments<float>();
+	BOOST_REQUIRE_EQUAL( segments.size(), 3 );
+	BOOST_CHECK_EQUAL( segments[0].size(), 9 );
+
+	data::segmented::fill( segments, 1.f );
+	BOOST_CHECK_EQUAL( data::segmented::accumulate( segments, 0. ), volume );
+
+	std::vector<float> idx( volume );
+
+	for( size_t i = 0; i < volume; i++ )
+		idx[i] = i;
+
+	// copy into the segments from a single segment of a different size
+	std::vector<data::Segment<float> > idx_segment( 1, data::Segment<float>( &idx[0], &idx[0] + volume ) );
+	data::segmented::copy( idx_segment, segments );
+
+	for( size_t i = 0; i < volume; i++ )
+		BOOST_REQUIRE_EQUAL( img.voxel<float>( i % 3, ( i / 3 ) % 3, i / 9 ), i );
+
+	data::segmented::transform( segments, segments, Double() );
+
+	const data::Image &cimg = img;
+	const std::pair<float, float> minmax = data::segmented::minmax( cimg.getSegments<float>() );
+	BOOST_CHECK_EQUAL( minmax.first, 0 );
+	BOOST_CHECK_EQUAL( minmax.second, ( volume - 1 ) * 2 );
+
+	std::vector<float> out( volume );
+	BOOST_CHECK( data::segmented::copy( cimg.getSegments<float>(), out.begin() ) == out.end() );
+	BOOST_CHECK( data::segmented::transform( segments, out.begin(), Double() ) == out.end() );
+
+	for( size_t i = 0; i < volume; i++ )
+		BOOST_REQUIRE_EQUAL( out[i], i * 4 );
+}
+
+BOOST_AUTO_TEST_CASE ( image_view_test )
+{
+	std::list<data::Chunk> chunks;
+
+	for( int i = 0; i < 3; i++ )
+		for( int j = 0; j < 4; j++ )
+			chunks.push_back( genSlice<int16_t>( 5, 4, j, j + i * 4 ) );
+
+	data::Image img( chunks );
+	BOOST_REQUIRE_EQUAL( img.getSizeAsVector(), util::vector4<size_t>( 5, 4, 4, 3 ) );
+
+	BOOST_CHECK( !data::ImageView<float>( img ).isValid() ); // wrong type
+
+	data::ImageView<int16_t> view( img );
+	BOOST_REQUIRE( view.isValid() );
+	BOOST_CHECK_EQUAL( view.getSizeAsVector(), img.getSizeAsVector() );
+
+	for( size_t t = 0; t < 3; t++ )
+		for( size_t z = 0; z < 4; z++ )
+			for( size_t y = 0; y < 4; y++ )
+				for( size_t x = 0; x < 5; x++ )
+					view.voxel( x, y, z, t ) = img.getLinearIndex( util::vector4<size_t>( x, y, z, t ) );
+
+	for( size_t i = 0; i < img.getVolume(); i++ ) {
+		size_t pos[4];
+		img.getCoordsFromLinIndex( i, pos );
+		BOOST_REQUIRE_EQUAL( img.voxel<int16_t>( pos[0], pos[1], pos[2], pos[3] ), i );
+	}
+
+	// the const variant sees the same data - also if the image consists of a single chunk
+	const data::Image single( data::MemChunk<int16_t>( img.getChunk( 0, 0, 0, 0 ) ) );
+	const data::ImageView<const int16_t> cview( single );
+	BOOST_REQUIRE( cview.isValid() );
+
+	for( size_t y = 0; y < 4; y++ )
+		for( size_t x = 0; x < 5; x++ )
+			BOOST_CHECK_EQUAL( cview.voxel( x, y ), view.voxel( x, y ) );
+}
+
 BOOST_AUTO_TEST_CASE ( image_voxel_value_test )
 {
 	//  get a voxel from inside and outside the image
@@ -86,5 +86,53 @@ BOOST_AUTO_TEST_CASE ( chunklist_sort_test )
 	BOOST_CHECK( chunks.isRectangular() );
 }
 
+data::MemChunk<float> genChunk( float z, int acq, uint16_t sequence = 0 )
+{
+	data::MemChunk<float> ch( 3, 3 );
+	ch.setPropertyAs( "indexOrigin", util::fvector3( 0, 0, z ) );
+	ch.setPropertyAs( "acquisitionNumber", acq );
+	ch.setPropertyAs( "sequenceNumber", sequence );
+	ch.setPropertyAs( "rowVec", util::fvector3( 1, 0 ) );
+	ch.setPropertyAs( "columnVec", util::fvector3( 0, 1 ) );
+	ch.setPropertyAs( "voxelSize", util::fvector3( 1, 1, 1 ) );
+	return ch;
+}
+
+BOOST_AUTO_TEST_CASE ( chunklist_index_test )
+{
+	data::_internal::SortedChunkList chunks( "rowVec,columnVec,sliceVec,coilChannelMask,sequenceNumber" );
+	chunks.addSecondarySort( "acquisitionNumber" );
+
+	// insert in "random" order
+	for ( int i = 0; i < 50; i++ ) {
+		const int acq = ( i * 7 ) % 50;
+		BOOST_REQUIRE( chunks.insert( genChunk( acq % 5, acq ) ) );
+	}
+
+	// a chunk with a different equal-property should be rejected
+	BOOST_CHECK( !chunks.insert( genChunk( 6, 50, 1 ) ) );
+
+	// -0 and 0 are the same position
+	BOOST_CHECK( !chunks.insert( genChunk( -0.f, 0 ) ) );
+
+	BOOST_REQUIRE( chunks.isRectangular() );
+	BOOST_REQUIRE_EQUAL( chunks.getHorizontalSize(), 10 );
+
+	std::vector<boost::shared_ptr<data::Chunk> > lookup = chunks.getLookup();
+	BOOST_REQUIRE_EQUAL( lookup.size(), 50 );
+
+	for ( size_t i = 0; i < lookup.size(); i++ ) { // position is the fastest running index
+		BOOST_CHECK_EQUAL( lookup[i]->propertyValue( "indexOrigin" ), util::fvector3( 0, 0, i % 5 ) );
+		BOOST_CHECK_EQUAL( lookup[i]->propertyValue( "acquisitionNumber" ), ( int )( i / 5 * 5 + i % 5 ) );
+	}
+
+	// the copy must use its own index
+	data::_internal::SortedChunkList copy( chunks );
+	chunks.clear();
+	BOOST_CHECK( !copy.insert( genChunk( 1, 1 ) ) ); // already there
+	BOOST_CHECK( copy.insert( genChunk( 1, 51 ) ) );
+	BOOST_CHECK( chunks.insert( genChunk( 1, 1 ) ) );
+}
+
 }
 }
@@ -9,7 +9,10 @@
 #define BOOST_TEST_MODULE ValueArrayTest
 #include <boost/test/unit_test.hpp>
 #include <DataStorage/valuearray.hpp>
+#include <DataStorage/numeric_convert.hpp>
+#include <DataStorage/image.hpp>
 #include <cmath>
+#include <numeric>
 
 
 namespace isis
@@ -50,6 +53,24 @@ public:
 
 bool Deleter::deleted = false;
 
+// convert src with all instruction sets supported by the cpu and compare the results to the generic conversion
+template<typename SRC, typename DST> void isaConvert( const data::ValueArray<SRC> &src )
+{
+	const data::_internal::numeric_isa best = data::_internal::getNumericIsa();
+	data::_internal::setNumericIsa( data::_internal::generic_isa );
+	const data::ValueArray<DST> reference = src.template copyAs<DST>();
+
+	for( int isa = data::_internal::avx2_isa; isa <= best; isa++ ) {
+		BOOST_REQUIRE( data::_internal::setNumericIsa( ( data::_internal::numeric_isa )isa ) );
+		const data::ValueArray<DST> result = src.template copyAs<DST>();
+
+		for( size_t i = 0; i < src.getLength(); i++ )
+			BOOST_REQUIRE_EQUAL( result[i], reference[i] );
+	}
+
+	data::_internal::setNumericIsa( best );
+}
+
 BOOST_AUTO_TEST_CASE( ValueArray_init_test )
 {
 	BOOST_CHECK( ! Deleter::deleted );
@@ -107,6 +128,65 @@ BOOST_AUTO_TEST_CASE( ValueArray_clone_test )
 	BOOST_CHECK( Deleter::deleted );
 }
 
+BOOST_AUTO_TEST_CASE( ValueArray_createByID_test )
+{
+	// there is a creator for every known type
+	const data::ValueArrayReference created = data::ValueArrayBase::createByID( data::ValueArray<uint16_t>::staticID, 5 );
+	BOOST_CHECK( created->is<uint16_t>() );
+	BOOST_CHECK_EQUAL( created->getLength(), 5 );
+
+	// and the converters of the table are the same as the ones reached by getConverterTo
+	const data::ValueArray<float> floats( 5 );
+	BOOST_REQUIRE( floats.getConverterTo( data::ValueArray<int16_t>::staticID ) );
+	BOOST_CHECK( floats.getConverterTo( data::ValueArray<float>::staticID ) );
+	BOOST_CHECK( !floats.getConverterTo( 0 ) ); // there is no type with that ID
+	BOOST_CHECK( !floats.getConverterTo( 0xFFFF ) );
+
+	const data::ValueArrayReference converted = floats.copyByID( data::ValueArray<int16_t>::staticID );
+	BOOST_CHECK( converted->is<int16_t>() );
+	BOOST_CHECK_EQUAL( converted->getLength(), 5 );
+}
+
+// sums up the values of any arithmetic ValueArray, and remembers the type it got
+struct TypedSum {
+	double sum;
+	unsigned short type;
+	template<typename T> void operator()( const data::ValueArray<T> &array ) {
+		sum = std::accumulate( array.begin(), array.end(), sum );
+		type = data::ValueArray<T>::staticID;
+	}
+};
+// sets all values of any ValueArray to their default
+struct TypedReset {
+	template<typename T> void operator()( data::ValueArray<T> &array ) {
+		std::fill( array.begin(), array.end(), T() );
+	}
+};
+
+BOOST_AUTO_TEST_CASE( ValueArray_applyTyped_test )
+{
+	data::ValueArray<int16_t> shorts( 4 );
+	shorts[0] = 1; shorts[1] = 2; shorts[2] = 3; shorts[3] = -4;
+	const data::ValueArrayReference ref( shorts );
+
+	TypedSum sum = {0, 0};
+	BOOST_CHECK( data::applyTyped<data::arithmetic_types>( *ref, sum ) );
+	BOOST_CHECK_EQUAL( sum.sum, 2 );
+	BOOST_CHECK_EQUAL( sum.type, data::ValueArray<int16_t>::staticID + 0 );
+
+	// types not in the list are not visited
+	const data::ValueArray<std::string> strings( 2 );
+	TypedSum not_visited = {0, 0};
+	BOOST_CHECK( !data::applyTyped<data::arithmetic_types>( strings, not_visited ) );
+	BOOST_CHECK_EQUAL( not_visited.type, 0 );
+
+	// visitors for all types get the writable array (and thus invalidate the min/max cache)
+	TypedReset reset;
+	BOOST_CHECK( data::applyTyped( *ref, reset ) );
+	BOOST_CHECK_EQUAL( shorts[3], 0 );
+	BOOST_CHECK_EQUAL( ref->getMinMax().first->as<int>(), 0 );
+}
+
 BOOST_AUTO_TEST_CASE( ValueArray_Reference_test )
 {
 	Deleter::deleted = false;
@@ -183,6 +263,25 @@ BOOST_AUTO_TEST_CASE( ValueArray_conv_scaling_test )
 	BOOST_CHECK_EQUAL( scale.second->as<double>(), 2 * scale.first->as<double>() );
 }
 
+BOOST_AUTO_TEST_CASE( ValueArray_needs_value_range_test )
+{
+	data::ValueArray<int16_t> i16Array( 12 );
+
+	// scaling into float or double never depends on the data
+	BOOST_CHECK( !i16Array.needsValueRange( data::ValueArray<float>::staticID ) );
+	BOOST_CHECK( !i16Array.needsValueRange( data::ValueArray<double>::staticID ) );
+	BOOST_CHECK( !i16Array.needsValueRange( data::ValueArray<int16_t>::staticID ) );
+	// neither does anything if noscale is requested
+	BOOST_CHECK( !i16Array.needsValueRange( data::ValueArray<uint8_t>::staticID, data::noscale ) );
+	// but downscaling into integers does
+	BOOST_CHECK( i16Array.needsValueRange( data::ValueArray<uint8_t>::staticID ) );
+	BOOST_CHECK( i16Array.needsValueRange( data::ValueArray<util::color24>::staticID ) );
+
+	data::scaling_pair scale = i16Array.getScalingTo( data::ValueArray<float>::staticID );
+	BOOST_CHECK_EQUAL( scale.first->as<double>(), 1 );
+	BOOST_CHECK_EQUAL( scale.second->as<double>(), 0 );
+}
+
 BOOST_AUTO_TEST_CASE( ValueArray_conversion_test )
 {
 	const float init[] = { -2, -1.8, -1.5, -1.3, -0.6, -0.2, 2, 1.8, 1.5, 1.3, 0.6, 0.2};
@@ -224,6 +323,87 @@ BOOST_AUTO_TEST_CASE( ValueArray_conversion_test )
 		BOOST_CHECK_EQUAL( ushortArray[i], ceil( init[i] * 1e5 * uscale + 32767.5 - .5 ) );
 }
 
+BOOST_AUTO_TEST_CASE( ValueArray_isa_conversion_test )
+{
+	data::ValueArray<float> floatArray( 1027 ); // not a multiple of the vector size, so the remainder is converted as well
+	data::ValueArray<int16_t> shortArray( 1027 );
+
+	for ( size_t i = 0; i < floatArray.getLength(); i++ ) {
+		floatArray[i] = ( i - 500.25 ) * 3.7;
+		shortArray[i] = i * 63 - 32000;
+	}
+
+	data::enableLog<util::DefaultMsgPrint>( error );
+	isaConvert<float, int8_t>( floatArray );
+	isaConvert<float, uint8_t>( floatArray );
+	isaConvert<float, int16_t>( floatArray );
+	isaConvert<float, uint16_t>( floatArray );
+	isaConvert<float, int32_t>( floatArray );
+	isaConvert<float, uint32_t>( floatArray );
+	isaConvert<float, int64_t>( floatArray );
+	isaConvert<float, double>( floatArray );
+
+	isaConvert<int16_t, uint8_t>( shortArray );
+	isaConvert<int16_t, uint16_t>( shortArray );
+	isaConvert<int16_t, int32_t>( shortArray );
+	isaConvert<int16_t, uint64_t>( shortArray );
+	isaConvert<int16_t, float>( shortArray );
+	isaConvert<int16_t, double>( shortArray );
+
+	// scaled conversions between integers must round (scaling is 1/10 and offset is 5)
+	const int16_t init[] = { -50, -1, 1, 2500};
+	data::ValueArray<int16_t> scaledArray( 4 );
+	scaledArray.copyFromMem( init, 4 );
+	isaConvert<int16_t, uint8_t>( scaledArray );
+	const data::ValueArray<uint8_t> ubyteArray = scaledArray.copyAs<uint8_t>();
+	BOOST_CHECK_EQUAL( ubyteArray[0], 0 );
+	BOOST_CHECK_EQUAL( ubyteArray[1], 5 );
+	BOOST_CHECK_EQUAL( ubyteArray[2], 5 );
+	BOOST_CHECK_EQUAL( ubyteArray[3], 255 );
+	data::enableLog<util::DefaultMsgPrint>( warning );
+}
+
+BOOST_AUTO_TEST_CASE( ValueArray_parallel_conversion_test )
+{
+	data::ValueArray<float> floatArray( 100003 ); // not a multiple of the page size
+	data::ValueArray<int16_t> shortArray( 100003 );
+
+	for ( size_t i = 0; i < floatArray.getLength(); i++ ) {
+		floatArray[i] = ( i - 50000.25 ) * 3.7;
+		shortArray[i] = i - 50000;
+	}
+
+	const data::ValueArray<uint8_t> serialBytes = floatArray.copyAs<uint8_t>();
+	const data::ValueArray<int16_t> serialShorts = floatArray.copyAs<int16_t>();
+	const data::ValueArray<int16_t> serialCopy = shortArray.copyAs<int16_t>();
+
+	// split up even the small arrays of this test
+	const size_t threshold = data::_internal::setParallelConvertThreshold( 0 );
+	data::setExecutionPolicy( data::parallel_execution );
+	const data::ValueArray<uint8_t> parallelBytes = floatArray.copyAs<uint8_t>();
+	const data::ValueArray<int16_t> parallelShorts = floatArray.copyAs<int16_t>();
+	const data::ValueArray<int16_t> parallelCopy = shortArray.copyAs<int16_t>();
+	data::setExecutionPolicy( data::sequential_execution );
+	data::_internal::setParallelConvertThreshold( threshold );
+
+	BOOST_CHECK_EQUAL( serialBytes.compare( 0, serialBytes.getLength() - 1, parallelBytes, 0 ), 0 );
+	BOOST_CHECK_EQUAL( serialShorts.compare( 0, serialShorts.getLength() - 1, parallelShorts, 0 ), 0 );
+	BOOST_CHECK_EQUAL( serialCopy.compare( 0, serialCopy.getLength() - 1, parallelCopy, 0 ), 0 );
+	BOOST_CHECK_EQUAL( shortArray.compare( 0, shortArray.getLength() - 1, parallelCopy, 0 ), 0 );
+	BOOST_CHECK_EQUAL( parallelBytes[100002], serialBytes[100002] );
+
+	// the blocks cover the whole array without overlap
+	const data::_internal::ConvertBlocks blocks = { 100, 1024, 11, 10000};
+	size_t covered = 0;
+
+	for( size_t i = 0; i < blocks.count; i++ ) {
+		BOOST_REQUIRE_EQUAL( blocks[i].first, covered );
+		covered += blocks[i].second;
+	}
+
+	BOOST_CHECK_EQUAL( covered, blocks.length );
+}
+
 BOOST_AUTO_TEST_CASE( ValueArray_complex_minmax_test )
 {
 	const std::complex<float> init[] = { std::complex<float>( -2, 1 ), -1.8, -1.5, -1.3, -0.6, -0.2, 2, 1.8, 1.5, 1.3, 0.6, std::complex<float>( 0.2, -5 )};
@@ -285,6 +465,53 @@ BOOST_AUTO_TEST_CASE( ValueArray_color_minmax_test )
 	BOOST_CHECK_EQUAL( minmax.second->as<util::color48>(), colmax );
 }
 
+template<typename T> void minMaxFloat()
+{
+	data::ValueArray<T> array( 1031 ); // not a multiple of the block size, so the remainder is used as well
+
+	for( int i = 0; i < 1031; i++ )
+		array[i] = ( i % 100 ) - 50.5;
+
+	array[3] = std::numeric_limits<T>::infinity(); // inf and nan must be ignored in the blocks
+	array[5] = -std::numeric_limits<T>::infinity();
+	array[7] = std::numeric_limits<T>::quiet_NaN();
+	array[1029] = std::numeric_limits<T>::quiet_NaN(); // and in the remainder
+	array[1030] = -std::numeric_limits<T>::infinity();
+	array[500] = -1000;
+	array[1027] = 1000;
+
+	std::pair<util::ValueReference, util::ValueReference> minmax = array.getMinMax();
+	BOOST_CHECK_EQUAL( minmax.first->as<T>(), -1000 );
+	BOOST_CHECK_EQUAL( minmax.second->as<T>(), 1000 );
+}
+BOOST_AUTO_TEST_CASE( ValueArray_float_minmax_test )
+{
+	minMaxFloat<float>();
+	minMaxFloat<double>();
+
+	data::ValueArray<std::complex<double> > cdArray( 101 );
+
+	for( int i = 0; i < 101; i++ )
+		cdArray[i] = std::complex<double>( i, -i );
+
+	cdArray[10] = std::complex<double>( std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN() );
+	std::pair< util::ValueReference, util::ValueReference > minmax = cdArray.getMinMax();
+	BOOST_CHECK_EQUAL( minmax.first->as<std::complex<double> >(),  std::complex< double >( 0, -100 ) );
+	BOOST_CHECK_EQUAL( minmax.second->as<std::complex<double> >(), std::complex< double >( 100, 0 ) );
+
+	data::ValueArray<util::color24> ccArray( 37 ); // 16 colors per block + 5 remaining
+
+	for( int i = 0; i < 37; i++ ) {
+		const util::color24 col = {( uint8_t )( 100 + i ), ( uint8_t )( 100 - i ), 7};
+		ccArray[i] = col;
+	}
+
+	minmax = ccArray.getMinMax();
+	const util::color24 colmin = {100, 64, 7}, colmax = {136, 100, 7};
+	BOOST_CHECK_EQUAL( minmax.first->as<util::color24>(), colmin );
+	BOOST_CHECK_EQUAL( minmax.second->as<util::color24>(), colmax );
+}
+
 BOOST_AUTO_TEST_CASE( ValueArray_color_conversion_test )
 {
 	const util::color48 init[] = { {0, 0, 0}, {100, 2, 4}, {200, 200, 200}, {510, 4, 2}};
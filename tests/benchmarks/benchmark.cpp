@@ -0,0 +1,212 @@
+#include "benchmark.hpp"
+#include <algorithm>
+#include <numeric>
+#include <fstream>
+#include <iomanip>
+#include <cmath>
+#include <cstdlib>
+#include <boost/regex.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <CoreUtils/common.hpp>
+
+namespace isis
+{
+namespace benchmark
+{
+
+volatile double sink = 0;
+
+void Suite::add( Case *c )
+{
+	m_cases.push_back( boost::shared_ptr<Case>( c ) );
+}
+
+const std::vector<boost::shared_ptr<Case> > &Suite::cases()const
+{
+	return m_cases;
+}
+
+Result Suite::measure( Case &c, size_t warmup, size_t repetitions )
+{
+	std::vector<double> times;
+	c.setUp();
+
+	for( size_t i = 0; i < warmup; i++ ) {
+		c.prepare();
+		c.run();
+	}
+
+	for( size_t i = 0; i < repetitions; i++ ) {
+		c.prepare();
+		const boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+		c.run();
+		times.push_back( ( boost::posix_time::microsec_clock::universal_time() - start ).total_microseconds() / 1e6 );
+	}
+
+	c.tearDown();
+
+	std::sort( times.begin(), times.end() );
+	Result ret;
+	ret.name = c.name();
+	ret.repetitions = times.size();
+	ret.min = times.front();
+	ret.median = times.size() % 2 ? times[times.size() / 2] : ( times[times.size() / 2 - 1] + times[times.size() / 2] ) / 2;
+	ret.mean = std::accumulate( times.begin(), times.end(), 0. ) / times.size();
+	double sqsum = 0;
+
+	for( std::vector<double>::const_iterator t = times.begin(); t != times.end(); ++t )
+		sqsum += ( *t - ret.mean ) * ( *t - ret.mean );
+
+	ret.stddev = times.size() > 1 ? std::sqrt( sqsum / ( times.size() - 1 ) ) : 0;
+	return ret;
+}
+
+void writeJson( std::ostream &out, const std::vector<Result> &results )
+{
+	out << "{\n\t\"benchmarks\": [\n" << std::setprecision( 9 );
+
+	for( std::vector<Result>::const_iterator r = results.begin(); r != results.end(); ++r ) {
+		out << "\t\t{\"name\": \"" << r->name << "\", \"repetitions\": " << r->repetitions
+			<< ", \"min\": " << r->min << ", \"median\": " << r->median << ", \"mean\": " << r->mean << ", \"stddev\": " << r->stddev << "}"
+			<< ( r + 1 == results.end() ? "\n" : ",\n" );
+	}
+
+	out << "\t]\n}\n";
+}
+
+std::map<std::string, double> readBaseline( std::istream &in )
+{
+	static const boost::regex entry( "\"name\"\\s*:\\s*\"([^\"]*)\".*\"median\"\\s*:\\s*([-+0-9.eE]+)" );
+	std::map<std::string, double> ret;
+	std::string line;
+	boost::smatch what;
+
+	while( std::getline( in, line ) ) {
+		if( boost::regex_search( line, what, entry ) )
+			ret[what[1]] = boost::lexical_cast<double>( what[2] );
+	}
+
+	return ret;
+}
+
+}
+}
+
+using namespace isis;
+
+namespace
+{
+void usage( const char *name )
+{
+	std::cerr
+			<< "Usage: " << name << " [options]" << std::endl
+			<< "  --list                 list the names of all cases and exit" << std::endl
+			<< "  --filter TEXT          only run cases whose name contains TEXT" << std::endl
+			<< "  --warmup N             untimed runs before measuring (default: 1)" << std::endl
+			<< "  --repetitions N        timed runs per case (default: 5)" << std::endl
+			<< "  --json FILE            write the results as JSON to FILE (\"-\" for stdout)" << std::endl
+			<< "  --baseline FILE        compare the medians with a file written by --json before" << std::endl
+			<< "  --threshold PERCENT    slowdown against the baseline reported as regression (default: 10)" << std::endl
+			<< "The exit code is 1 if a regression was found." << std::endl;
+}
+}
+
+int main( int argc, char **argv )
+{
+	size_t warmup = 1, repetitions = 5;
+	double threshold = 10;
+	std::string filter, json, baseline;
+	bool list = false;
+
+	for( int i = 1; i < argc; i++ ) {
+		const std::string arg( argv[i] );
+
+		if( arg == "--list" ) {
+			list = true;
+		} else if( i + 1 < argc && arg == "--filter" ) {
+			filter = argv[++i];
+		} else if( i + 1 < argc && arg == "--warmup" ) {
+			warmup = boost::lexical_cast<size_t>( argv[++i] );
+		} else if( i + 1 < argc && arg == "--repetitions" ) {
+			repetitions = std::max<size_t>( boost::lexical_cast<size_t>( argv[++i] ), 1 );
+		} else if( i + 1 < argc && arg == "--json" ) {
+			json = argv[++i];
+		} else if( i + 1 < argc && arg == "--baseline" ) {
+			baseline = argv[++i];
+		} else if( i + 1 < argc && arg == "--threshold" ) {
+			threshold = boost::lexical_cast<double>( argv[++i] );
+		} else {
+			usage( argv[0] );
+			return arg == "--help" ? 0 : 2;
+		}
+	}
+
+	enableLogGlobal<util::DefaultMsgPrint>( warning );
+
+	benchmark::Suite suite;
+	benchmark::addCoreCases( suite );
+	benchmark::addDataCases( suite );
+
+	std::map<std::string, double> base;
+
+	if( !baseline.empty() ) {
+		std::ifstream in( baseline.c_str() );
+
+		if( !in ) {
+			std::cerr << "Could not read the baseline " << baseline << std::endl;
+			return 2;
+		}
+
+		base = benchmark::readBaseline( in );
+	}
+
+	std::vector<benchmark::Result> results;
+	size_t regressions = 0;
+	std::ostream &table = json == "-" ? std::cerr : std::cout; // keep stdout clean for the JSON
+
+	for( std::vector<boost::shared_ptr<benchmark::Case> >::const_iterator c = suite.cases().begin(); c != suite.cases().end(); ++c ) {
+		if( !filter.empty() && ( *c )->name().find( filter ) == std::string::npos )
+			continue;
+
+		if( list ) {
+			std::cout << ( *c )->name() << std::endl;
+			continue;
+		}
+
+		const benchmark::Result r = benchmark::Suite::measure( **c, warmup, repetitions );
+		results.push_back( r );
+		table << std::left << std::setw( 40 ) << r.name << std::right << std::fixed << std::setprecision( 6 )
+				  << " median " << r.median << "s min " << r.min << "s stddev " << r.stddev << "s";
+
+		const std::map<std::string, double>::const_iterator found = base.find( r.name );
+
+		if( found != base.end() && found->second > 0 ) {
+			const double change = ( r.median / found->second - 1 ) * 100;
+			table << std::setprecision( 1 ) << std::showpos << " (" << change << "%)" << std::noshowpos;
+
+			if( change > threshold ) {
+				table << " REGRESSION";
+				regressions++;
+			}
+		}
+
+		table << std::endl;
+	}
+
+	if( !json.empty() ) {
+		if( json == "-" ) {
+			benchmark::writeJson( std::cout, results );
+		} else {
+			std::ofstream out( json.c_str() );
+			benchmark::writeJson( out, results );
+		}
+	}
+
+	if( regressions ) {
+		table << regressions << " case(s) are more than " << threshold << "% slower than the baseline" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
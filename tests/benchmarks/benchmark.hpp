@@ -0,0 +1,73 @@
+#ifndef BENCHMARK_HPP
+#define BENCHMARK_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <iostream>
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace isis
+{
+namespace benchmark
+{
+
+/**
+ * A named benchmark case.
+ * setUp is called once before the runs, so preparing the data is not timed.
+ * Only run is timed, it is called for the warmup runs and then for every repetition.
+ * prepare is called (untimed) before every run, for cases whose run consumes its input.
+ */
+class Case: boost::noncopyable
+{
+	const std::string m_name;
+public:
+	Case( const std::string &name ): m_name( name ) {}
+	virtual ~Case() {}
+	const std::string &name()const {return m_name;}
+	/// prepare the data (not timed)
+	virtual void setUp() {}
+	/// restore the input consumed by the previous run (not timed)
+	virtual void prepare() {}
+	/// the work to be timed
+	virtual void run() = 0;
+	/// free the data (not timed)
+	virtual void tearDown() {}
+};
+
+/// statistics of the runs of one case (times in seconds)
+struct Result {
+	std::string name;
+	size_t repetitions;
+	double min, median, mean, stddev;
+};
+
+/// the list of all cases
+class Suite
+{
+	std::vector<boost::shared_ptr<Case> > m_cases;
+public:
+	/// add a case (the suite takes ownership)
+	void add( Case *c );
+	const std::vector<boost::shared_ptr<Case> > &cases()const;
+	/// run the case warmup times, and then repetitions times measuring each run
+	static Result measure( Case &c, size_t warmup, size_t repetitions );
+};
+
+/// write the results as JSON (one case per line, so baselines are easy to diff)
+void writeJson( std::ostream &out, const std::vector<Result> &results );
+/// read the medians out of a file written by writeJson
+std::map<std::string, double> readBaseline( std::istream &in );
+
+// the cases (see coreBenchmarks.cpp and dataBenchmarks.cpp)
+void addCoreCases( Suite &suite );
+void addDataCases( Suite &suite );
+
+/// keep the compiler from optimizing away results of the measured code
+extern volatile double sink;
+
+}
+}
+
+#endif // BENCHMARK_HPP
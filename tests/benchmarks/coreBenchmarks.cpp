@@ -0,0 +1,126 @@
+#include "benchmark.hpp"
+#include <CoreUtils/propmap.hpp>
+#include <CoreUtils/value.hpp>
+#include <CoreUtils/matrix.hpp>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+
+namespace isis
+{
+namespace benchmark
+{
+namespace
+{
+
+// looks up every property of a map with many properties
+class PropertyLookup: public Case
+{
+	const bool m_nested;
+	util::PropertyMap m_map;
+	std::vector<util::PropertyMap::PropPath> m_paths;
+public:
+	PropertyLookup( const std::string &name, bool nested ): Case( name ), m_nested( nested ) {}
+	void setUp() {
+		for( int32_t i = 0; i < 500; i++ ) {
+			const std::string key = "key" + boost::lexical_cast<std::string>( i );
+			const util::PropertyMap::PropPath path = m_nested ?
+					util::PropertyMap::PropPath( ( "DICOM/CSAImageHeaderInfo/group" + boost::lexical_cast<std::string>( i % 10 ) + "/" + key ).c_str() ) :
+					util::PropertyMap::PropPath( key.c_str() );
+			m_map.setPropertyAs( path, i );
+			m_paths.push_back( path );
+		}
+	}
+	void run() {
+		int32_t sum = 0;
+
+		for( size_t r = 0; r < 100; r++ ) {
+			for( std::vector<util::PropertyMap::PropPath>::const_iterator p = m_paths.begin(); p != m_paths.end(); ++p ) {
+				if( m_map.hasProperty( *p ) )
+					sum += m_map.getPropertyAs<int32_t>( *p );
+			}
+		}
+
+		sink = sum;
+	}
+	void tearDown() {
+		m_map = util::PropertyMap();
+		m_paths.clear();
+	}
+};
+
+// looks up a property by a string, so the path has to be parsed every time
+class PropertyStringLookup: public Case
+{
+	util::PropertyMap m_map;
+public:
+	PropertyStringLookup(): Case( "propmap/lookup_string" ) {}
+	void setUp() {
+		m_map.setPropertyAs( "DICOM/CSAImageHeaderInfo/SliceMeasurementDuration", 42 );
+		m_map.setPropertyAs( "acquisitionNumber", 1 );
+	}
+	void run() {
+		int32_t sum = 0;
+
+		for( size_t r = 0; r < 50000; r++ ) {
+			sum += m_map.getPropertyAs<int32_t>( "DICOM/CSAImageHeaderInfo/SliceMeasurementDuration" );
+			sum += m_map.getPropertyAs<int32_t>( "acquisitionNumber" );
+		}
+
+		sink = sum;
+	}
+};
+
+// converts values into other types
+class ValueAs: public Case
+{
+public:
+	ValueAs(): Case( "value/as" ) {}
+	void run() {
+		double sum = 0;
+
+		for( int32_t i = 0; i < 200000; i++ ) {
+			const util::Value<int32_t> val( i % 30000 ); // stay in the range of uint16_t
+			sum += val.as<float>() + val.as<uint16_t>();
+		}
+
+		sink = sum;
+	}
+};
+
+// matrix by vector and vector by vector multiplication
+class VectorMult: public Case
+{
+	const bool m_matrix;
+public:
+	VectorMult( const std::string &name, bool matrix ): Case( name ), m_matrix( matrix ) {}
+	void run() {
+		const util::vector4<float> b1( 1 / std::sqrt( 2. ), -1 / std::sqrt( 2. ) ), b2( 1 / std::sqrt( 2. ), 1 / std::sqrt( 2. ) );
+		const util::Matrix4x4<float> rot( b1, b2 );
+		util::vector4<float> v( 1, 1 );
+		float sum = 0;
+
+		for( size_t i = 0; i < 1000000; i++ ) {
+			if( m_matrix )
+				sum += rot.dot( v )[1];
+			else
+				sum += ( v * v )[0];
+		}
+
+		sink = sum;
+	}
+};
+
+}
+
+void addCoreCases( Suite &suite )
+{
+	suite.add( new PropertyLookup( "propmap/lookup_flat", false ) );
+	suite.add( new PropertyLookup( "propmap/lookup_nested", true ) );
+	suite.add( new PropertyStringLookup );
+	suite.add( new ValueAs );
+	suite.add( new VectorMult( "vector/matrix_mult", true ) );
+	suite.add( new VectorMult( "vector/vector_mult", false ) );
+}
+
+}
+}
@@ -0,0 +1,255 @@
+#include "benchmark.hpp"
+#include <DataStorage/image.hpp>
+#include <DataStorage/numeric_convert.hpp>
+#include <DataStorage/endianess.hpp>
+#include <DataStorage/sortedchunklist.hpp>
+#include <boost/foreach.hpp>
+#include <numeric>
+
+namespace isis
+{
+namespace benchmark
+{
+namespace
+{
+
+const size_t array_bytes = 64 * 1024 * 1024;
+
+data::Chunk makeSlice( size_t size, size_t slice, uint32_t acq )
+{
+	data::MemChunk<int16_t> ret( size, size );
+	ret.setPropertyAs( "rowVec", util::fvector3( 1, 0 ) );
+	ret.setPropertyAs( "columnVec", util::fvector3( 0, 1 ) );
+	ret.setPropertyAs( "indexOrigin", util::fvector3( 0, 0, slice ) );
+	ret.setPropertyAs( "voxelSize", util::fvector3( 1, 1, 1 ) );
+	ret.setPropertyAs( "acquisitionNumber", acq );
+	ret.setPropertyAs( "sequenceNumber", ( uint16_t )0 );
+	return ret;
+}
+// slices*timesteps chunks of size*size voxels
+std::list<data::Chunk> makeSlices( size_t size, size_t slices, size_t timesteps )
+{
+	std::list<data::Chunk> ret;
+	uint32_t acq = 0;
+
+	for( size_t t = 0; t < timesteps; t++ )
+		for( size_t s = 0; s < slices; s++ )
+			ret.push_back( makeSlice( size, s, acq++ ) );
+
+	return ret;
+}
+
+// numeric_convert of 64MB of SRC into DST
+template<typename SRC, typename DST> class Convert: public Case
+{
+	const bool m_scaled;
+	std::vector<SRC> m_src;
+	std::vector<DST> m_dst;
+public:
+	Convert( const std::string &name, bool scaled ): Case( name ), m_scaled( scaled ) {}
+	void setUp() {
+		m_src.resize( array_bytes / sizeof( SRC ) );
+		m_dst.resize( m_src.size() );
+
+		for( size_t i = 0; i < m_src.size(); i++ )
+			m_src[i] = i % 251;
+	}
+	void run() {
+		if( m_scaled )
+			data::numeric_convert( &m_src[0], &m_dst[0], m_src.size(), 3.5, 2 );
+		else
+			data::numeric_convert( &m_src[0], &m_dst[0], m_src.size(), 1, 0 );
+	}
+	void tearDown() {
+		std::vector<SRC>().swap( m_src );
+		std::vector<DST>().swap( m_dst );
+	}
+};
+
+// getMinMax of 64MB of T
+template<typename T> class MinMax: public Case
+{
+	boost::scoped_ptr<data::ValueArray<T> > m_array;
+public:
+	MinMax( const std::string &name ): Case( name ) {}
+	void setUp() {
+		m_array.reset( new data::ValueArray<T>( array_bytes / sizeof( T ) ) );
+
+		for( size_t i = 0; i < m_array->getLength(); i++ )
+			( *m_array )[i] = i % 251;
+	}
+	void run() {
+		sink = m_array->getMinMax().second->template as<double>();
+	}
+	void tearDown() {m_array.reset();}
+};
+
+// endianSwapArray of 64MB of T
+template<typename T> class Byteswap: public Case
+{
+	boost::scoped_ptr<data::ValueArray<T> > m_src, m_dst;
+public:
+	Byteswap( const std::string &name ): Case( name ) {}
+	void setUp() {
+		m_src.reset( new data::ValueArray<T>( array_bytes / sizeof( T ) ) );
+		m_dst.reset( new data::ValueArray<T>( m_src->getLength() ) );
+	}
+	void run() {
+		const data::ValueArray<T> &src = *m_src;
+		data::endianSwapArray( src.begin(), src.end(), m_dst->begin() );
+	}
+	void tearDown() {
+		m_src.reset();
+		m_dst.reset();
+	}
+};
+
+// an image of 64 slices of 256x256 voxels to iterate over
+class ImageIteration: public Case
+{
+public:
+	enum mode {typed_write, generic_read, voxel_write};
+private:
+	const mode m_mode;
+	boost::scoped_ptr<data::TypedImage<int16_t> > m_image;
+public:
+	ImageIteration( const std::string &name, mode m ): Case( name ), m_mode( m ) {}
+	void setUp() {
+		std::list<data::Chunk> chunks = makeSlices( 256, 64, 1 );
+		m_image.reset( new data::TypedImage<int16_t>( data::Image( chunks ) ) );
+	}
+	void run() {
+		switch( m_mode ) {
+		case typed_write:
+			BOOST_FOREACH( data::TypedImage<int16_t>::reference ref, *m_image ) {
+				ref = 42;
+			}
+			break;
+		case generic_read: {
+			const data::Image &img = *m_image;
+			double sum = 0;
+			BOOST_FOREACH( data::Image::const_reference ref, img ) {
+				sum += ref->as<double>();
+			}
+			sink = sum;
+		}
+		break;
+		case voxel_write: {
+			const util::vector4<size_t> size = m_image->getSizeAsVector();
+
+			for( size_t s = 0; s < size[data::sliceDim]; s++ )
+				for( size_t c = 0; c < size[data::columnDim]; c++ )
+					for( size_t r = 0; r < size[data::rowDim]; r++ )
+						m_image->voxel<int16_t>( r, c, s ) = 42;
+		}
+		break;
+		}
+	}
+	void tearDown() {m_image.reset();}
+};
+
+struct TypedSum {
+	double sum;
+	template<typename T> void operator()( const data::ValueArray<T> &array ) {sum = std::accumulate( array.begin(), array.end(), sum );}
+};
+
+// sums up a chunk using applyTyped
+class ApplyTypedSum: public Case
+{
+	boost::scoped_ptr<data::Chunk> m_chunk;
+public:
+	ApplyTypedSum(): Case( "iterate/applyTyped_sum" ) {}
+	void setUp() {m_chunk.reset( new data::MemChunk<int16_t>( 256, 256, 64 ) );}
+	void run() {
+		const data::Chunk &ch = *m_chunk;
+		TypedSum sum = {0};
+		data::applyTyped<data::arithmetic_types>( ch.getValueArrayBase(), sum );
+		sink = sum.sum;
+	}
+	void tearDown() {m_chunk.reset();}
+};
+
+// builds and indexes an image out of 64 slices in 32 timesteps
+class ReIndex: public Case
+{
+	std::list<data::Chunk> m_chunks, m_input;
+public:
+	ReIndex(): Case( "image/insert_reIndex" ) {}
+	void setUp() {m_chunks = makeSlices( 64, 64, 32 );}
+	void prepare() {m_input = m_chunks;} // the image takes the chunks out of the list
+	void run() {
+		const data::Image img( m_input ); // indexes the image
+		sink = img.getVolume();
+	}
+	void tearDown() {
+		m_chunks.clear();
+		m_input.clear();
+	}
+};
+
+// inserts 64 slices in 32 timesteps into a SortedChunkList
+class SortedInsert: public Case
+{
+	const bool m_bulk;
+	std::vector<data::Chunk> m_chunks, m_input;
+public:
+	SortedInsert( const std::string &name, bool bulk ): Case( name ), m_bulk( bulk ) {}
+	void setUp() {
+		const std::list<data::Chunk> chunks = makeSlices( 8, 64, 32 );
+		m_chunks.assign( chunks.begin(), chunks.end() );
+	}
+	void prepare() {
+		if( m_bulk )
+			m_input = m_chunks; // insertBulk takes the chunks out of the vector
+	}
+	void run() {
+		data::_internal::SortedChunkList list( "voxelSize,rowVec,columnVec" );
+		list.addSecondarySort( "acquisitionNumber" );
+
+		if( m_bulk ) {
+			sink = list.insertBulk( m_input );
+		} else {
+			BOOST_FOREACH( const data::Chunk & ch, m_chunks ) {
+				list.insert( ch );
+			}
+		}
+	}
+	void tearDown() {
+		m_chunks.clear();
+		m_input.clear();
+	}
+};
+
+}
+
+void addDataCases( Suite &suite )
+{
+	suite.add( new Convert<float, int16_t>( "convert/float_int16_scaled", true ) );
+	suite.add( new Convert<float, uint8_t>( "convert/float_uint8_scaled", true ) );
+	suite.add( new Convert<int16_t, uint16_t>( "convert/int16_uint16_scaled", true ) );
+	suite.add( new Convert<int16_t, float>( "convert/int16_float", false ) );
+	suite.add( new Convert<uint32_t, double>( "convert/uint32_double", false ) );
+
+	suite.add( new MinMax<int8_t>( "minmax/int8" ) );
+	suite.add( new MinMax<int16_t>( "minmax/int16" ) );
+	suite.add( new MinMax<uint32_t>( "minmax/uint32" ) );
+	suite.add( new MinMax<float>( "minmax/float" ) );
+	suite.add( new MinMax<double>( "minmax/double" ) );
+
+	suite.add( new Byteswap<uint16_t>( "byteswap/uint16" ) );
+	suite.add( new Byteswap<uint32_t>( "byteswap/uint32" ) );
+	suite.add( new Byteswap<double>( "byteswap/double" ) );
+	suite.add( new Byteswap<util::color48>( "byteswap/color48" ) );
+
+	suite.add( new ImageIteration( "iterate/typed_image_write", ImageIteration::typed_write ) );
+	suite.add( new ImageIteration( "iterate/generic_image_read", ImageIteration::generic_read ) );
+	suite.add( new ImageIteration( "iterate/image_voxel_write", ImageIteration::voxel_write ) );
+	suite.add( new ApplyTypedSum );
+
+	suite.add( new ReIndex );
+	suite.add( new SortedInsert( "sortedchunklist/insert", false ) );
+	suite.add( new SortedInsert( "sortedchunklist/insertBulk", true ) );
+}
+
+}
+}